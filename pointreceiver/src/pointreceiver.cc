@@ -1,9 +1,14 @@
 #include "pointreceiver.h"
+#include "../../src/radio/delta_codec.h"
+#include "../../src/radio/frame_header.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <mutex>
 #include <numeric>
 #include <readerwriterqueue/readerwritercircularbuffer.h>
+#include <string>
 #include <thread>
 #include <vector>
 #define ZMQ_BUILD_DRAFT_API
@@ -17,16 +22,31 @@ std::unique_ptr<std::thread> dish_thread;
 std::mutex buffer_access;
 
 using bob::types::PointCloud;
+using pc::radio::FrameEncoding;
+using pc::radio::FrameHeader;
+
+// measured from the header of each live frame
+static std::atomic<int> dropped_frame_count = 0;
+static std::atomic<float> frame_latency_ms = 0;
+
 static moodycamel::BlockingReaderWriterCircularBuffer<PointCloud>
     cloud_queue(1);
 static std::vector<PointCloud> snapshot_frames;
 static PointCloud synthesized_snapshot_frames;
 
 // Start a thread that handles networking
-int startNetworkThread(const char *point_caster_address, int timeout_ms) {
+int startNetworkThread(const char *point_caster_address, int timeout_ms,
+                       int lod) {
   request_thread_stop = false;
+  dropped_frame_count = 0;
+  // the caller's string isn't guaranteed to outlive this call. an address
+  // without a transport is a tcp host and port.
+  std::string endpoint = point_caster_address;
+  if (endpoint.find("://") == std::string::npos) {
+    endpoint = fmt::format("tcp://{}", endpoint);
+  }
   dish_thread =
-      std::make_unique<std::thread>([&, point_caster_address, timeout_ms]() {
+      std::make_unique<std::thread>([&, endpoint, timeout_ms, lod]() {
         using namespace std::chrono;
         using namespace std::chrono_literals;
 
@@ -48,11 +68,10 @@ int startNetworkThread(const char *point_caster_address, int timeout_ms) {
 	// constexpr auto recv_timeout_ms = 1000;
 	// dish.set(zmq::sockopt::rcvtimeo, recv_timeout_ms);
 
-        //auto endpoint = fmt::format("tcp://{}", point_caster_address);
-	auto endpoint = "tcp://127.0.0.1:9992";
-	      // auto endpoint = "tcp://192.168.2.200:9999";
         log(fmt::format("Attempting to connect to '{}'", endpoint));
-        dish.connect(endpoint);
+        // udp frames are sent to the dish's address, so the dish binds it
+        if (endpoint.starts_with("udp://")) dish.bind(endpoint);
+        else dish.connect(endpoint);
 
         if (dish.handle() == nullptr) {
           log("Failed to connect");
@@ -64,7 +83,24 @@ int startNetworkThread(const char *point_caster_address, int timeout_ms) {
         dish.join("snapshots");
         log("Joined live and snapshots groups");
 
+        // levels of detail refine each other, so we need every level up to
+        // the one requested
+        const auto finest_level =
+            lod < 0 ? pc::radio::max_lod_levels - 1
+                    : std::min(lod, pc::radio::max_lod_levels - 1);
+        for (int level = 0; level <= finest_level; level++) {
+          dish.join(fmt::format("live/lod{}", level).c_str());
+        }
+        log(fmt::format("Joined levels of detail 0 to {}", finest_level));
+
         time_point<system_clock> last_snapshot_time = system_clock::now();
+        std::uint64_t last_sequence = 0;
+        // rebuilds full frames when the server sends keyframes and deltas
+        pc::radio::DeltaDecoder delta_decoder;
+        // the levels of detail received so far of the frame being assembled
+        PointCloud lod_frame;
+        std::uint64_t lod_sequence = 0;
+        int next_lod_level = 0;
 
         while (!request_thread_stop) {
 
@@ -81,8 +117,68 @@ int startNetworkThread(const char *point_caster_address, int timeout_ms) {
           buffer.assign(bytes_ptr, bytes_ptr + msg_size);
           // log(fmt::format("bytes size: {}", buffer.size()));
           // log(fmt::format("pc.size: {}", point_cloud.size()));
-          if (group == "live") {
-            cloud_queue.try_enqueue(PointCloud::deserialize(buffer));
+          if (group.starts_with("live")) {
+            // live frames start with a header, followed by the point cloud
+            FrameHeader header;
+            if (!pc::radio::read_frame_header(buffer.data(), buffer.size(),
+                                              header)) {
+              log("Received a live frame without a valid header");
+              continue;
+            }
+            // a sequence lower than the last means the server restarted
+            if (last_sequence != 0 && header.sequence > last_sequence + 1) {
+              dropped_frame_count +=
+                  static_cast<int>(header.sequence - last_sequence - 1);
+              // a missing delta leaves us without the frame the next one
+              // applies to
+              delta_decoder.invalidate();
+            }
+            last_sequence = header.sequence;
+            const auto now_us =
+                duration_cast<microseconds>(
+                    system_clock::now().time_since_epoch())
+                    .count();
+            frame_latency_ms = (now_us - header.capture_time_us) / 1000.0f;
+
+            if (header.level_count > 1) {
+              // a frame is complete once every level we joined has
+              // arrived. if one goes missing the rest of the frame is
+              // skipped.
+              if (header.level == 0) {
+                lod_frame = PointCloud{};
+                lod_sequence = header.sequence;
+                next_lod_level = 0;
+              }
+              if (header.sequence != lod_sequence ||
+                  header.level != next_lod_level) {
+                continue;
+              }
+              next_lod_level++;
+              if (buffer.size() > sizeof(FrameHeader)) {
+                buffer.erase(buffer.begin(),
+                             buffer.begin() + sizeof(FrameHeader));
+                lod_frame += PointCloud::deserialize(buffer);
+              }
+              const int last_level =
+                  std::min<int>(finest_level, header.level_count - 1);
+              if (header.level == last_level) {
+                cloud_queue.try_enqueue(std::move(lod_frame));
+                lod_frame = PointCloud{};
+              }
+            } else if (header.encoding == FrameEncoding::PointCloud) {
+              buffer.erase(buffer.begin(),
+                           buffer.begin() + sizeof(FrameHeader));
+              cloud_queue.try_enqueue(PointCloud::deserialize(buffer));
+            } else {
+              // deltas are skipped until the next keyframe if we can't
+              // apply them
+              const auto keyframe = header.encoding == FrameEncoding::Keyframe;
+              if (delta_decoder.decode(buffer.data() + sizeof(FrameHeader),
+                                       buffer.size() - sizeof(FrameHeader),
+                                       keyframe)) {
+                cloud_queue.try_enqueue(delta_decoder.point_cloud());
+              }
+            }
 	  } else if (group == "snapshots") {
 	    auto msg_begin = static_cast<const char *>(incoming_msg.data());
             std::string header_msg(msg_begin, msg_begin + 5);
@@ -133,6 +229,8 @@ bool dequeue() {
 }
 
 int pointCount() { return point_cloud.size(); }
+int droppedFrameCount() { return dropped_frame_count; }
+float frameLatencyMs() { return frame_latency_ms; }
 bob::types::position *pointPositions() { return point_cloud.positions.data(); }
 bob::types::color *pointColors() { return point_cloud.colors.data(); }
 }
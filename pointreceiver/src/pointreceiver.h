@@ -26,10 +26,17 @@ void log(std::string text) {
 #endif
 
 extern "C" {
-	JNIEXPORT int startNetworkThread(const char* point_caster_address = "127.0.0.1:9999", int timeout_ms = 0);
+	// lod is the finest level of detail to receive when the server splits
+	// frames into levels, where 0 is the coarsest. -1 receives every level.
+	JNIEXPORT int startNetworkThread(const char* point_caster_address = "127.0.0.1:9999", int timeout_ms = 0, int lod = -1);
 	JNIEXPORT int stopNetworkThread();
 	JNIEXPORT bool dequeue();
 	JNIEXPORT int pointCount();
+	// frames the server sent that never arrived, since the thread started
+	JNIEXPORT int droppedFrameCount();
+	// from sensor capture to the arrival of the latest frame, which relies
+	// on the server and receiver clocks being synchronised
+	JNIEXPORT float frameLatencyMs();
 	JNIEXPORT bob::types::position* pointPositions();
 	JNIEXPORT bob::types::color* pointColors();
 }
@@ -16,7 +16,7 @@ public class PointReceiver : MonoBehaviour
 {
 
     [DllImport("pointreceiver", EntryPoint = "startNetworkThread", CharSet = CharSet.Ansi)]
-    public static extern int StartNetworkThread(string pointCasterAddress);
+    public static extern int StartNetworkThread(string pointCasterAddress, int timeoutMs, int lod);
 
     [DllImport("pointreceiver", EntryPoint = "stopNetworkThread")]
     public static extern int StopNetworkThread();
@@ -39,6 +39,8 @@ public class PointReceiver : MonoBehaviour
     public static PointReceiver Instance;
 
     public string PointCasterAddress = "127.0.0.1:9999";
+    // the finest level of detail to receive, or -1 for every level
+    public int LevelOfDetail = -1;
     public RawImage PositionPreview;
     public RawImage ColorPreview;
 
@@ -68,7 +70,7 @@ public class PointReceiver : MonoBehaviour
     void OnEnable() 
     {
         RenderPipelineManager.endCameraRendering += DisposeFrameResources;
-        StartNetworkThread(PointCasterAddress);
+        StartNetworkThread(PointCasterAddress, 0, LevelOfDetail);
     }
 
     void OnDisable() 
@@ -1,11 +1,17 @@
 #include "device.h"
+#include "device_merge.h"
 #include "../path.h"
 #include "../logger.h"
+#include "../utils/worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <imgui.h>
-#include <k4abttypes.h>
 #include <tracy/Tracy.hpp>
 
+#if WITH_K4A
 #include "k4a/k4a_driver.h"
+#endif
 
 #ifndef __CUDACC__
 #include <zpp_bits.h>
@@ -18,48 +24,90 @@ using pc::operators::OperatorList;
 
 Device::Device(DeviceConfiguration config) : _config(config){};
 
-pc::types::PointCloud
-synthesized_point_cloud(OperatorList operators) {
+bool synthesized_point_cloud(
+    pc::types::PointCloud &result, OperatorList operators,
+    std::chrono::steady_clock::time_point *capture_time) {
   ZoneScopedN("PointCloud::synthesized_point_cloud");
 
-  if (Device::attached_devices.size() == 0)
-    return pc::types::PointCloud{};
-
-  // TODO
+  std::lock_guard<std::mutex> lock(Device::devices_access);
 
-  // can run device->point_cloud(operators) in parallel before using them to
-  // construct the result
+  const auto device_count = Device::attached_devices.size();
+  if (device_count == 0) {
+    result.positions.clear();
+    result.colors.clear();
+    if (capture_time) *capture_time = std::chrono::steady_clock::now();
+    return false;
+  }
 
-  // For the += operator, return PointCloud& instead of PointCloud to avoid
-  // copying the result.
+  auto &workers = pc::utils::worker_pool();
 
-  // it would be good to be able to preallocate memory here?
+  // run every device's pipeline concurrently, including the per-device
+  // operator stage
+  std::atomic_bool new_frames{false};
+  {
+    ZoneScopedN("run operators");
+    workers.parallel_for(device_count, [&](std::size_t i) {
+      if (Device::attached_devices[i]->process(operators)) new_frames = true;
+    });
+  }
 
-  pc::types::PointCloud result{};
+  if (capture_time) {
+    // devices that don't know their capture time count as captured now
+    *capture_time = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < device_count; i++) {
+      const auto device_capture_time =
+          Device::attached_devices[i]->capture_time();
+      if (device_capture_time.time_since_epoch().count() != 0 &&
+          device_capture_time < *capture_time) {
+        *capture_time = device_capture_time;
+      }
+    }
+  }
 
-  std::lock_guard<std::mutex> lock(Device::devices_access);
+  {
+    ZoneScopedN("merge");
+    const auto merge_start_time = std::chrono::steady_clock::now();
+
+    // each device downloads straight into its own slice of the arena
+    merge_device_clouds(
+        result, device_count,
+        [](std::size_t i) {
+          return Device::attached_devices[i]->point_count();
+        },
+        [](std::size_t i, pc::types::position *positions,
+           pc::types::color *colors) {
+          Device::attached_devices[i]->download(positions, colors);
+        },
+        workers);
+
+    const std::chrono::duration<double, std::milli> merge_duration =
+        std::chrono::steady_clock::now() - merge_start_time;
+    TracyPlot("Synthesis device count", static_cast<int64_t>(device_count));
+    TracyPlot("Synthesis merge ms", merge_duration.count());
+  }
 
-  for (auto &device : Device::attached_devices) {
-    {
-      ZoneScopedN("run operators & add result");
-      result += device->point_cloud(operators);
-    }
+  // operators that need to see every device's points run once on the
+  // merged cloud
+  for (auto &operator_host : operators) {
+    operator_host.get().run_post_merge(result);
   }
 
-  return result;
+  return new_frames;
 }
 
 // TODO all of this skeleton stuff needs to be made generic accross multiple
 // camera types
 std::vector<K4ASkeleton> scene_skeletons() {
   std::vector<K4ASkeleton> result;
+#if WITH_K4A
   for (auto &device : Device::attached_devices) {
     auto driver = dynamic_cast<K4ADriver *>(device->_driver.get());
-    if (!driver->tracking_bodies()) continue;
+    if (!driver || !driver->tracking_bodies()) continue;
     for (auto &skeleton : driver->skeletons()) {
       result.push_back(skeleton);
     }
   }
+#endif
   return result;
 }
 
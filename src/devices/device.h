@@ -10,11 +10,11 @@
 #include "device_config.gen.h"
 #include "driver.h"
 #include <Corrade/Containers/Pointer.h>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <imgui.h>
 #include <iterator>
-#include <k4abttypes.h>
 #include <memory>
 #include <mutex>
 #include <pointclouds.h>
@@ -22,6 +22,13 @@
 #include <variant>
 #include <vector>
 
+#if WITH_K4A
+#include <k4abttypes.h>
+#else
+// skeletons keep k4abt's layout in builds without the body tracking sdk
+#define K4ABT_JOINT_COUNT 32
+#endif
+
 namespace pc::devices {
 
 enum class DeviceType { UnknownDevice, K4A, K4W2, Rs2 };
@@ -43,10 +50,18 @@ public:
 
   bool broadcast_enabled() { return _enable_broadcast; }
 
-  auto point_cloud(pc::operators::OperatorList operators = {}) {
-    return _driver->point_cloud(_config, operators);
+  bool process(pc::operators::OperatorList operators = {}) {
+    return _driver->process(_config, operators);
   };
 
+  std::size_t point_count() const { return _driver->point_count(); }
+
+  void download(pc::types::position *positions, pc::types::color *colors) {
+    _driver->download(positions, colors);
+  }
+
+  auto capture_time() const { return _driver->capture_time(); }
+
   DeviceConfiguration& config() { return _config; };
 
   void draw_imgui_controls();
@@ -68,8 +83,15 @@ protected:
   }
 };
 
-extern pc::types::PointCloud
-synthesized_point_cloud(pc::operators::OperatorList operators = {});
+// Merges the output of all attached devices into result, reusing its
+// existing capacity. If capture_time is given it receives when the oldest
+// of the merged device frames was captured. Returns false if no device had
+// a new frame since the last call, in which case result holds the same
+// points as the last merge. Consumers should take frames from a FrameBus
+// rather than calling this directly.
+extern bool synthesized_point_cloud(
+    pc::types::PointCloud &result, pc::operators::OperatorList operators = {},
+    std::chrono::steady_clock::time_point *capture_time = nullptr);
 
 // TODO make all the k4a stuff more generic
 using pc::types::Float4;
@@ -2,7 +2,7 @@
 
 #include "../serialization.h"
 #include "../structs.h"
-#include <k4a/k4atypes.h>
+#include <string>
 
 namespace pc::devices {
 
@@ -24,7 +24,7 @@ struct AutoTiltConfiguration {
 
 struct K4AConfiguration {
   bool unfolded = false;
-  int depth_mode = (int)K4A_DEPTH_MODE_NFOV_UNBINNED;
+  int depth_mode = 2; // K4A_DEPTH_MODE_NFOV_UNBINNED
   int exposure = 10000;
   int brightness = 128;
   int contrast = 5;
@@ -33,6 +33,23 @@ struct K4AConfiguration {
   AutoTiltConfiguration auto_tilt; // @optional
 };
 
+struct ReplayConfiguration {
+  bool unfolded = false;
+  std::string file_path = "";
+  int playback_mode = 0; // 0: real-time, 1: as fast as possible
+  bool loop = true;
+  float speed = 1; // @minmax(0.1f, 10)
+};
+
+struct SyntheticConfiguration {
+  bool unfolded = false;
+  bool enabled = false;
+  int point_count = 262144; // @minmax(1, 262144)
+  int motion_pattern = 0; // 0: wave, 1: orbit, 2: noise, 3: static
+  float frame_rate = 30; // @minmax(1, 120)
+  float motion_speed = 1; // @minmax(0, 10)
+};
+
 struct DeviceConfiguration {
   bool flip_x = false; 
   bool flip_y = false;
@@ -48,8 +65,11 @@ struct DeviceConfiguration {
   Float3 rotation_deg{0, 0, 0}; // @minmax(-360, 360)
   float scale = 1; // @minmax(0, 10)
   int sample = 1; 
+  int compute_backend = 0; // 0: CUDA, 1: CPU // @optional
   BodyTrackingConfiguration body; // @optional
   K4AConfiguration k4a; // @optional
+  ReplayConfiguration replay; // @optional
+  SyntheticConfiguration synthetic; // @optional
 };
 
 } // namespace pc::devices
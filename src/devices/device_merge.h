@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../structs.h"
+#include "../utils/worker_pool.h"
+#include <cstddef>
+#include <vector>
+
+namespace pc::devices {
+
+// Merges the output of device_count devices into result, which acts as an
+// arena reused from frame to frame. It's sized from every device's point
+// count up front, giving each device its own slice, and then the devices
+// download straight into their slices in parallel, so merging costs one
+// copy of each point and no allocation once the arena is big enough.
+//
+// point_count(i) returns device i's point count, and download(i, positions,
+// colors) writes that many points starting at the given pointers.
+template <typename PointCount, typename Download>
+void merge_device_clouds(
+    pc::types::PointCloud &result, std::size_t device_count,
+    PointCount &&point_count, Download &&download,
+    pc::utils::WorkerPool &workers = pc::utils::worker_pool()) {
+
+  // kept between frames to avoid allocating. the workers reach it through
+  // this reference, since naming a thread_local inside the lambda would
+  // give each worker its own empty copy
+  thread_local std::vector<std::size_t> offsets_storage;
+  auto &device_offsets = offsets_storage;
+  device_offsets.resize(device_count);
+
+  std::size_t total_point_count = 0;
+  for (std::size_t i = 0; i < device_count; i++) {
+    device_offsets[i] = total_point_count;
+    total_point_count += point_count(i);
+  }
+  result.positions.resize(total_point_count);
+  result.colors.resize(total_point_count);
+
+  workers.parallel_for(device_count, [&](std::size_t i) {
+    const auto offset = device_offsets[i];
+    download(i, result.positions.data() + offset,
+             result.colors.data() + offset);
+  });
+}
+
+} // namespace pc::devices
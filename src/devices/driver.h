@@ -5,6 +5,7 @@
 #include "device_config.gen.h"
 #include <Magnum/Magnum.h>
 #include <Magnum/Math/Vector3.h>
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -25,11 +26,27 @@ public:
   virtual bool is_open() const = 0;
   virtual bool is_running() const = 0;
 
-  virtual pc::types::PointCloud
-  point_cloud(const DeviceConfiguration &config,
-	      pc::operators::OperatorList operators = {}) = 0;
+  // run the processing stages over the newest captured frame. returns
+  // false, keeping the last processed frame, if nothing new was captured.
+  virtual bool process(const DeviceConfiguration &config,
+                       pc::operators::OperatorList operators = {}) = 0;
+
+  // the number of points in the last processed frame
+  virtual std::size_t point_count() const = 0;
+
+  // copy the last processed frame into buffers with room for point_count()
+  // points, so that callers can download straight into a merged cloud
+  virtual void download(pc::types::position *positions,
+                        pc::types::color *colors) = 0;
+
   virtual std::string id() const = 0;
 
+  // when the last processed frame was captured, or the clock's epoch if the
+  // driver doesn't know
+  virtual std::chrono::steady_clock::time_point capture_time() const {
+    return {};
+  }
+
   virtual void set_paused(bool pause) = 0;
 
   virtual void start_alignment() = 0;
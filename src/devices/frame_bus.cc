@@ -0,0 +1,95 @@
+#include "frame_bus.h"
+#include "../logger.h"
+#include "../operators/operator_timing.h"
+#include "device.h"
+#include "ingest/ingest_pipeline.h"
+#include <tracy/Tracy.hpp>
+
+namespace pc::devices {
+
+using namespace std::chrono;
+
+FrameBus::FrameBus(pc::operators::SessionOperatorHost &session_operator_host)
+    : _session_operator_host(session_operator_host),
+      _synthesis_thread(
+          [this](std::stop_token stop_token) { synthesize(stop_token); }) {}
+
+FrameBus::~FrameBus() {
+  _synthesis_thread.request_stop();
+  if (_synthesis_thread.joinable()) _synthesis_thread.join();
+  pc::logger->info("Ended frame bus thread");
+}
+
+FrameRef FrameBus::latest() const {
+  std::lock_guard lock(_frame_access);
+  return _latest;
+}
+
+FrameRef FrameBus::wait_for_frame(std::uint64_t after_sequence,
+                                  milliseconds timeout) const {
+  std::unique_lock lock(_frame_access);
+  const auto published = _frame_published.wait_for(lock, timeout, [&] {
+    return _latest && _latest->sequence > after_sequence;
+  });
+  if (!published) return nullptr;
+  return _latest;
+}
+
+void FrameBus::synthesize(std::stop_token stop_token) {
+  std::uint64_t sequence = 0;
+  std::uint64_t handled_uploads = 0;
+  std::size_t published_device_count = 0;
+
+  while (!stop_token.stop_requested()) {
+    // uploads that arrive while we're synthesizing leave the count ahead of
+    // handled_uploads, so the next wait returns straight away
+    const auto upload_count = IngestPipeline::frame_uploaded.wait_for(
+        handled_uploads, device_poll_interval);
+    const bool uploaded = upload_count != handled_uploads;
+    handled_uploads = upload_count;
+
+    std::size_t device_count;
+    {
+      std::lock_guard lock(Device::devices_access);
+      device_count = Device::attached_devices.size();
+    }
+    const bool devices_changed = device_count != published_device_count;
+    if (!uploaded && !devices_changed) continue;
+
+    ZoneScopedN("FrameBus::synthesize");
+
+    // the spare frame is only ever referenced by the bus and by consumers
+    // that took it while it was the latest frame, so once we hold the only
+    // reference nobody else can be reading it
+    std::shared_ptr<Frame> frame;
+    if (_spare && _spare.use_count() == 1) frame = std::move(_spare);
+    else frame = std::make_shared<Frame>();
+
+    const bool new_frames = synthesized_point_cloud(
+        frame->point_cloud, {_session_operator_host},
+        &frame->capture_timestamp);
+    // every operator pass that ran during synthesis has queued its timings
+    // by now, and this is the only thread that publishes them
+    pc::operators::publish_queued_timings();
+    if (!new_frames && !devices_changed) {
+      // the upload was already consumed by an earlier synthesis, so there's
+      // nothing new to publish. keep the buffers for next time.
+      _spare = std::move(frame);
+      continue;
+    }
+    published_device_count = device_count;
+    frame->sequence = ++sequence;
+    frame->timestamp = steady_clock::now();
+
+    {
+      std::lock_guard lock(_frame_access);
+      _spare = std::move(_latest);
+      _latest = std::move(frame);
+    }
+    _frame_published.notify_all();
+
+    TracyPlot("Frame bus sequence", static_cast<int64_t>(sequence));
+  }
+}
+
+} // namespace pc::devices
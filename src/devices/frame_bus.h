@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../operators/session_operator_host.h"
+#include "../structs.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace pc::devices {
+
+// A synthesized frame of every attached device's output. Frames are never
+// modified once published, so consumers can hold on to them for as long as
+// they need without copying.
+struct Frame {
+  std::uint64_t sequence = 0;
+  // when the frame was published
+  std::chrono::steady_clock::time_point timestamp;
+  // when the oldest sensor frame merged into it was captured
+  std::chrono::steady_clock::time_point capture_timestamp;
+  pc::types::PointCloud point_cloud;
+};
+
+using FrameRef = std::shared_ptr<const Frame>;
+
+// Runs device synthesis on its own thread, so that each frame is merged and
+// run through the session operators exactly once no matter how many
+// consumers there are. The renderer, radio and snapshots each take a
+// reference to the latest frame at their own rate.
+//
+// The bus sleeps until a device uploads a new sensor frame, and only
+// publishes when at least one device had new data (or the set of devices
+// changed), so a new sequence number always means new points.
+class FrameBus {
+public:
+  // how often the bus wakes without an upload, to notice devices being
+  // removed
+  static constexpr auto device_poll_interval = std::chrono::milliseconds(50);
+
+  FrameBus(pc::operators::SessionOperatorHost &session_operator_host);
+  ~FrameBus();
+
+  FrameBus(const FrameBus &) = delete;
+  FrameBus &operator=(const FrameBus &) = delete;
+
+  // the most recently published frame, or nullptr if nothing has been
+  // published yet. never blocks on synthesis.
+  FrameRef latest() const;
+
+  // blocks until a frame newer than after_sequence is published, returning
+  // nullptr if the timeout expires first
+  FrameRef wait_for_frame(std::uint64_t after_sequence,
+                          std::chrono::milliseconds timeout) const;
+
+private:
+  pc::operators::SessionOperatorHost &_session_operator_host;
+
+  mutable std::mutex _frame_access;
+  mutable std::condition_variable _frame_published;
+  std::shared_ptr<Frame> _latest;
+
+  // the previously published frame, reused for the next synthesis once no
+  // consumer holds it any more
+  std::shared_ptr<Frame> _spare;
+
+  std::jthread _synthesis_thread;
+  void synthesize(std::stop_token stop_token);
+};
+
+} // namespace pc::devices
@@ -0,0 +1,342 @@
+#include "../../logger.h"
+#include "ingest_pipeline.h"
+#include "ingest_point.cuh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/device_vector.h>
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_output_iterator.h>
+#include <thrust/system/omp/execution_policy.h>
+#include <tracy/Tracy.hpp>
+
+// #include "../../operators/noise_operator.gen.h"
+// #include "../../operators/noise_operator.cuh"
+
+namespace pc::devices {
+
+static constexpr std::size_t slot_count = 3;
+
+struct IngestPipelineDeviceMemory {
+  // uploads and processing are issued on separate streams so that a capture
+  // thread's upload doesn't queue behind the previous frame's kernels.
+  // they're non-blocking so they never synchronise with other devices
+  // through the legacy default stream.
+  cudaStream_t upload_stream;
+  cudaStream_t compute_stream;
+
+  std::array<cudaEvent_t, slot_count> upload_complete;
+  cudaEvent_t download_complete;
+
+  // page-locked host staging so that async copies can DMA directly instead
+  // of going through a driver-side pageable copy
+  std::array<Short3 *, slot_count> staging_positions;
+  std::array<color *, slot_count> staging_colors;
+  position *pinned_output_positions;
+  color *pinned_output_colors;
+
+  std::array<thrust::device_vector<Short3>, slot_count> incoming_positions;
+  std::array<thrust::device_vector<color>, slot_count> incoming_colors;
+  thrust::device_vector<position> output_positions;
+  thrust::device_vector<color> output_colors;
+  thrust::device_vector<int> output_indices;
+
+  IngestPipelineDeviceMemory(std::size_t point_count)
+      : output_positions(point_count), output_colors(point_count),
+        output_indices(point_count) {
+    cudaStreamCreateWithFlags(&upload_stream, cudaStreamNonBlocking);
+    cudaStreamCreateWithFlags(&compute_stream, cudaStreamNonBlocking);
+    for (std::size_t slot = 0; slot < slot_count; slot++) {
+      cudaEventCreateWithFlags(&upload_complete[slot], cudaEventDisableTiming);
+      cudaMallocHost(&staging_positions[slot], point_count * sizeof(Short3));
+      cudaMallocHost(&staging_colors[slot], point_count * sizeof(color));
+      incoming_positions[slot].resize(point_count);
+      incoming_colors[slot].resize(point_count);
+    }
+    cudaEventCreateWithFlags(&download_complete, cudaEventDisableTiming);
+    cudaMallocHost(&pinned_output_positions, point_count * sizeof(position));
+    cudaMallocHost(&pinned_output_colors, point_count * sizeof(color));
+  }
+
+  ~IngestPipelineDeviceMemory() {
+    cudaStreamSynchronize(upload_stream);
+    cudaStreamSynchronize(compute_stream);
+    for (std::size_t slot = 0; slot < slot_count; slot++) {
+      cudaEventDestroy(upload_complete[slot]);
+      cudaFreeHost(staging_positions[slot]);
+      cudaFreeHost(staging_colors[slot]);
+    }
+    cudaEventDestroy(download_complete);
+    cudaFreeHost(pinned_output_positions);
+    cudaFreeHost(pinned_output_colors);
+    cudaStreamDestroy(upload_stream);
+    cudaStreamDestroy(compute_stream);
+  }
+};
+
+struct IngestPipelineHostMemory {
+  std::array<std::vector<Short3>, slot_count> incoming_positions;
+  std::array<std::vector<color>, slot_count> incoming_colors;
+  std::vector<position> output_positions;
+  std::vector<color> output_colors;
+  std::vector<int> output_indices;
+
+  IngestPipelineHostMemory(std::size_t point_count)
+      : output_positions(point_count), output_colors(point_count),
+        output_indices(point_count) {
+    for (std::size_t slot = 0; slot < slot_count; slot++) {
+      incoming_positions[slot].resize(point_count);
+      incoming_colors[slot].resize(point_count);
+    }
+  }
+};
+
+static bool cuda_device_available() {
+  int device_count = 0;
+  return cudaGetDeviceCount(&device_count) == cudaSuccess && device_count > 0;
+}
+
+IngestPipeline::IngestPipeline(std::size_t point_count,
+                               std::string_view name, IngestBackend backend)
+    : _point_count(point_count), _backend(IngestBackend::Host) {
+  _slot_backend.fill(IngestBackend::Host);
+  _output_backend = IngestBackend::Host;
+  // operator indices are depth pixel indices until the cloud is merged
+  _operator_scratch.history.pixel_count = point_count;
+  _operator_scratch.source = name;
+  set_backend(backend);
+}
+
+void IngestPipeline::set_backend(IngestBackend backend) {
+  _requested_backend = backend;
+  if (backend == IngestBackend::Cuda && !cuda_device_available()) {
+    static std::atomic_bool warned{false};
+    if (!warned.exchange(true)) {
+      pc::logger->warn("No CUDA device available, ingesting on the host");
+    }
+    backend = IngestBackend::Host;
+  }
+  // memory has to exist before an uploading thread can observe the switch
+  if (backend == IngestBackend::Cuda && _device_memory == nullptr) {
+    _device_memory = new IngestPipelineDeviceMemory(_point_count);
+  } else if (backend == IngestBackend::Host && _host_memory == nullptr) {
+    _host_memory = new IngestPipelineHostMemory(_point_count);
+  }
+  _backend.store(backend, std::memory_order_release);
+}
+
+IngestPipeline::~IngestPipeline() {
+  delete _device_memory;
+  delete _host_memory;
+}
+
+void IngestPipeline::upload(
+    const Short3 *positions, const color *colors,
+    std::chrono::steady_clock::time_point capture_time) {
+  ZoneScopedN("IngestPipeline::upload");
+
+  const auto slot = _slots.back();
+  const auto backend = _backend.load(std::memory_order_acquire);
+
+  if (backend == IngestBackend::Cuda) {
+    auto &memory = *_device_memory;
+    // the staging buffers may still be in use by this slot's last transfer
+    cudaEventSynchronize(memory.upload_complete[slot]);
+    std::memcpy(memory.staging_positions[slot], positions,
+                _point_count * sizeof(Short3));
+    std::memcpy(memory.staging_colors[slot], colors,
+                _point_count * sizeof(color));
+    cudaMemcpyAsync(thrust::raw_pointer_cast(
+                        memory.incoming_positions[slot].data()),
+                    memory.staging_positions[slot],
+                    _point_count * sizeof(Short3), cudaMemcpyHostToDevice,
+                    memory.upload_stream);
+    cudaMemcpyAsync(
+        thrust::raw_pointer_cast(memory.incoming_colors[slot].data()),
+        memory.staging_colors[slot], _point_count * sizeof(color),
+        cudaMemcpyHostToDevice, memory.upload_stream);
+    cudaEventRecord(memory.upload_complete[slot], memory.upload_stream);
+  } else {
+    auto &memory = *_host_memory;
+    std::copy(positions, positions + _point_count,
+              memory.incoming_positions[slot].begin());
+    std::copy(colors, colors + _point_count,
+              memory.incoming_colors[slot].begin());
+  }
+
+  _slot_backend[slot] = backend;
+  _slot_capture_time[slot] = capture_time;
+  _slots.publish();
+  frame_uploaded.notify();
+}
+
+bool IngestPipeline::process(const DeviceConfiguration &config,
+                             const Eigen::Matrix4f &transform,
+                             const OperatorList &operator_list) {
+
+  ZoneScopedN("IngestPipeline::process");
+
+  const auto configured_backend = (IngestBackend)config.compute_backend;
+  if (configured_backend != _requested_backend) {
+    set_backend(configured_backend);
+  }
+
+  if (!_slots.acquire()) return false;
+  const auto slot = _slots.front();
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  _output_backend = _slot_backend[slot];
+  _output_capture_time = _slot_capture_time[slot];
+  if (_output_backend == IngestBackend::Cuda) {
+    _output_point_count =
+        process_cuda(slot, config, transform, operator_list);
+  } else {
+    _output_point_count =
+        process_host(slot, config, transform, operator_list);
+  }
+
+  const auto scratch_stats = _operator_scratch.stats();
+  TracyPlot("Operator scratch allocations",
+            static_cast<int64_t>(scratch_stats.allocation_count));
+  TracyPlot("Operator scratch MB",
+            scratch_stats.bytes_allocated / (1024.0 * 1024.0));
+
+  // throughput of each backend, for comparing them on the same workload
+  const std::chrono::duration<double, std::milli> process_time =
+      std::chrono::steady_clock::now() - start_time;
+  if (process_time.count() > 0) {
+    const auto points_per_ms = _point_count / process_time.count();
+    if (_output_backend == IngestBackend::Cuda) {
+      TracyPlot("Ingest points/ms (CUDA)", points_per_ms);
+    } else {
+      TracyPlot("Ingest points/ms (CPU)", points_per_ms);
+    }
+  }
+
+  return true;
+}
+
+std::size_t IngestPipeline::process_cuda(int slot,
+                                         const DeviceConfiguration &config,
+                                         const Eigen::Matrix4f &transform,
+                                         const OperatorList &operator_list) {
+  auto &memory = *_device_memory;
+  auto &incoming_positions = memory.incoming_positions[slot];
+  auto &incoming_colors = memory.incoming_colors[slot];
+  auto &output_positions = memory.output_positions;
+  auto &output_colors = memory.output_colors;
+  auto &output_indices = memory.output_indices;
+
+  const auto on_compute_stream =
+      thrust::cuda::par(_operator_scratch.device).on(memory.compute_stream);
+
+  // processing only waits for this slot's transfer, not any other work
+  cudaStreamWaitEvent(memory.compute_stream, memory.upload_complete[slot]);
+
+  // zip position and color buffers together so we can run our algorithms on
+  // the dataset as a single point-cloud
+  auto incoming_points_begin = thrust::make_zip_iterator(
+      thrust::make_tuple(incoming_positions.begin(), incoming_colors.begin(),
+                         thrust::make_counting_iterator(0)));
+
+  // the ingest functor is applied lazily while the points are being
+  // compacted, so filtering, transformation and bounds checking happen in
+  // a single pass that writes only the surviving points
+  auto ingested_points_begin = thrust::make_transform_iterator(
+      incoming_points_begin, ingest_point(config, transform));
+
+  auto operator_output_begin = thrust::make_zip_iterator(thrust::make_tuple(
+      output_positions.begin(), output_colors.begin(), output_indices.begin()));
+
+  // copy_if has to wait on the compute stream to return its end iterator,
+  // but that only blocks on this device's work
+  auto operator_output_end = thrust::copy_if(
+      on_compute_stream, ingested_points_begin,
+      ingested_points_begin + _point_count, operator_output_begin,
+      is_ingested{});
+
+  // operators run on the same stream, so the download below is ordered
+  // after them without synchronising with any other device
+  if (!operator_list.empty()) {
+    operator_output_end = pc::operators::apply(
+        operator_output_begin, operator_output_end, operator_list,
+        _operator_scratch, memory.compute_stream);
+  }
+
+  // we can determine the output count using the resulting output iterator
+  // from running the kernels
+  const std::size_t output_point_count =
+      std::distance(operator_output_begin, operator_output_end);
+
+  cudaMemcpyAsync(memory.pinned_output_positions,
+                  thrust::raw_pointer_cast(output_positions.data()),
+                  output_point_count * sizeof(position),
+                  cudaMemcpyDeviceToHost, memory.compute_stream);
+  cudaMemcpyAsync(memory.pinned_output_colors,
+                  thrust::raw_pointer_cast(output_colors.data()),
+                  output_point_count * sizeof(color), cudaMemcpyDeviceToHost,
+                  memory.compute_stream);
+  cudaEventRecord(memory.download_complete, memory.compute_stream);
+
+  return output_point_count;
+}
+
+std::size_t IngestPipeline::process_host(int slot,
+                                         const DeviceConfiguration &config,
+                                         const Eigen::Matrix4f &transform,
+                                         const OperatorList &operator_list) {
+  auto &memory = *_host_memory;
+  auto &incoming_positions = memory.incoming_positions[slot];
+  auto &incoming_colors = memory.incoming_colors[slot];
+
+  auto incoming_points_begin = thrust::make_zip_iterator(
+      thrust::make_tuple(incoming_positions.data(), incoming_colors.data(),
+                         thrust::make_counting_iterator(0)));
+  auto ingested_points_begin = thrust::make_transform_iterator(
+      incoming_points_begin, ingest_point(config, transform));
+
+  auto output_begin = thrust::make_zip_iterator(thrust::make_tuple(
+      memory.output_positions.data(), memory.output_colors.data(),
+      memory.output_indices.data()));
+
+  auto output_end = thrust::copy_if(thrust::omp::par(_operator_scratch.host),
+                                    ingested_points_begin,
+                                    ingested_points_begin + _point_count,
+                                    output_begin, is_ingested{});
+
+  output_end = pc::operators::apply(output_begin, output_end, operator_list,
+                                    _operator_scratch);
+
+  return std::distance(output_begin, output_end);
+}
+
+void IngestPipeline::download(position *positions, color *colors) {
+  ZoneScopedN("IngestPipeline::download");
+
+  const std::size_t point_count = _output_point_count;
+
+  if (_output_backend == IngestBackend::Cuda) {
+    auto &memory = *_device_memory;
+    cudaEventSynchronize(memory.download_complete);
+    std::copy(memory.pinned_output_positions,
+              memory.pinned_output_positions + point_count, positions);
+    std::copy(memory.pinned_output_colors,
+              memory.pinned_output_colors + point_count, colors);
+  } else {
+    auto &memory = *_host_memory;
+    std::copy(memory.output_positions.begin(),
+              memory.output_positions.begin() + point_count, positions);
+    std::copy(memory.output_colors.begin(),
+              memory.output_colors.begin() + point_count, colors);
+  }
+}
+
+} // namespace pc::devices
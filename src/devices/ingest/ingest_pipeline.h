@@ -0,0 +1,149 @@
+#pragma once
+
+#include "../../operators/session_operator_host.h"
+#include "../../structs.h"
+#include "../../utils/triple_buffer.h"
+#include "../../utils/update_signal.h"
+#include "../device_config.gen.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+
+//#define EIGEN_DONT_VECTORIZE
+#include <Eigen/Geometry>
+
+namespace pc::devices {
+
+using pc::operators::OperatorList;
+using pc::types::color;
+using pc::types::PointCloud;
+using pc::types::position;
+using pc::types::Short3;
+
+// where ingest and the session operators execute. the values match
+// DeviceConfiguration::compute_backend.
+enum class IngestBackend { Cuda = 0, Host = 1 };
+
+// Forward declarations hide CUDA types, allowing the pipeline to have CUDA
+// members. This prevents issues when this header is included in TUs not
+// compiled with nvcc.
+struct IngestPipelineDeviceMemory;
+struct IngestPipelineHostMemory;
+
+// The stages that turn a raw sensor frame (Short3 positions in millimetres
+// and colors, one per depth pixel) into a world-space point cloud: crop
+// filtering, transformation, bounds filtering and the session operators.
+// Sensor drivers only need to supply the frame and the device transform
+// built by ingest_transform().
+//
+// Incoming frames are triple buffered, so a capture thread can upload new
+// frames while the previous one is still being processed, and neither side
+// ever waits for the other. With the CUDA backend each pipeline owns its own
+// streams and events, so devices never wait on each other's work. The host
+// backend runs the same stages and operators across every CPU core.
+class IngestPipeline {
+public:
+  // notified after a frame is uploaded to any pipeline, so consumers of
+  // device output can wait for new sensor data instead of polling
+  static inline pc::utils::UpdateSignal frame_uploaded;
+
+  // falls back to the host backend if CUDA was requested but no CUDA device
+  // is available. the name identifies the device in operator timings.
+  IngestPipeline(std::size_t point_count, std::string_view name,
+                 IngestBackend backend = IngestBackend::Cuda);
+  ~IngestPipeline();
+
+  IngestPipeline(const IngestPipeline &) = delete;
+  IngestPipeline &operator=(const IngestPipeline &) = delete;
+  IngestPipeline(IngestPipeline &&) = delete;
+  IngestPipeline &operator=(IngestPipeline &&) = delete;
+
+  IngestBackend backend() const { return _backend.load(); }
+
+  // switch backends at runtime. must be called from the thread that calls
+  // process() and download(). frames uploaded before the switch are still
+  // processed by the backend they were uploaded to.
+  void set_backend(IngestBackend backend);
+
+  // stage a raw frame for processing, replacing any staged frame that
+  // hasn't been processed yet. one thread may upload while another is
+  // inside process().
+  void upload(const Short3 *positions, const color *colors,
+              std::chrono::steady_clock::time_point capture_time =
+                  std::chrono::steady_clock::now());
+
+  // run every processing stage over the most recently uploaded frame.
+  // returns false if no new frame has been uploaded since the last call.
+  // switches backend first if config.compute_backend has changed.
+  bool process(const DeviceConfiguration &config,
+               const Eigen::Matrix4f &transform,
+               const OperatorList &operators);
+
+  // the number of points in the last processed frame
+  std::size_t point_count() const { return _output_point_count; }
+
+  // wait for the last processed frame and copy it into host buffers with
+  // room for point_count() points. can be called again for the same frame.
+  void download(position *positions, color *colors);
+
+  // drop the last processed frame, so that point_count() is zero until the
+  // next one is processed. safe to call from any thread.
+  void clear() { _output_point_count = 0; }
+
+  // when the last processed frame was captured
+  std::chrono::steady_clock::time_point capture_time() const {
+    return _output_capture_time;
+  }
+
+  // allocations made for operator temporaries. in steady state the count
+  // stops increasing.
+  pc::operators::ScratchStats operator_scratch_stats() const {
+    return _operator_scratch.stats();
+  }
+
+private:
+  std::size_t _point_count;
+  std::atomic<std::size_t> _output_point_count = 0;
+  std::atomic<IngestBackend> _backend;
+  IngestBackend _requested_backend;
+
+  // allocated before a backend is first selected and kept until
+  // destruction, so an upload racing a backend switch never touches freed
+  // memory
+  IngestPipelineDeviceMemory *_device_memory = nullptr;
+  IngestPipelineHostMemory *_host_memory = nullptr;
+
+  // upload() writes into the back slot and process() reads the front slot
+  pc::utils::TripleBufferIndex _slots;
+
+  // the backend each slot's frame was uploaded to
+  std::array<IngestBackend, 3> _slot_backend;
+  IngestBackend _output_backend;
+
+  std::array<std::chrono::steady_clock::time_point, 3> _slot_capture_time{};
+  std::chrono::steady_clock::time_point _output_capture_time{};
+
+  // only touched from the processing thread
+  pc::operators::OperatorScratch _operator_scratch;
+
+  std::size_t process_cuda(int slot, const DeviceConfiguration &config,
+                           const Eigen::Matrix4f &transform,
+                           const OperatorList &operators);
+  std::size_t process_host(int slot, const DeviceConfiguration &config,
+                           const Eigen::Matrix4f &transform,
+                           const OperatorList &operators);
+};
+
+// Folds every per-device transformation (auto-tilt, the sensor to world axis
+// flip, input translation, axis flips, rotation about the alignment center,
+// offsets and scale) into a single affine matrix. This is computed once per
+// frame on the host so the per-point work is one matrix multiply.
+Eigen::Matrix4f
+ingest_transform(const DeviceConfiguration &config,
+                 const position &alignment_center = {0, 0, 0},
+                 const position &aligned_position_offset = {0, 0, 0},
+                 const Eigen::Matrix3f &auto_tilt = Eigen::Matrix3f::Identity());
+
+} // namespace pc::devices
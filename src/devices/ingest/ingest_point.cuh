@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../../operators/operator.h"
+#include "../../structs.h"
+#include "../device_config.gen.h"
+#include <thrust/functional.h>
+#include <thrust/tuple.h>
+#include <type_traits>
+
+//#define EIGEN_DONT_VECTORIZE
+#include <Eigen/Geometry>
+
+namespace pc::devices {
+
+using pc::types::color;
+using pc::types::position;
+using pc::types::Short3;
+
+typedef thrust::tuple<Short3, color, int> point_in_t;
+typedef thrust::tuple<position, color> point_t;
+typedef thrust::tuple<position, color, int> indexed_point_t;
+
+// The parts of a DeviceConfiguration that the ingest functor reads. The
+// whole configuration holds strings, so it can't be copied to the device.
+struct ingest_filter {
+  bool flip_x;
+  bool flip_y;
+  bool flip_z;
+  MinMaxShort crop_x;
+  MinMaxShort crop_y;
+  MinMaxShort crop_z;
+  MinMaxShort bound_x;
+  MinMaxShort bound_y;
+  MinMaxShort bound_z;
+  int sample;
+
+  ingest_filter(const DeviceConfiguration &config)
+      : flip_x(config.flip_x), flip_y(config.flip_y), flip_z(config.flip_z),
+        crop_x(config.crop_x), crop_y(config.crop_y), crop_z(config.crop_z),
+        bound_x(config.bound_x), bound_y(config.bound_y),
+        bound_z(config.bound_z), sample(config.sample) {}
+};
+
+static_assert(std::is_trivially_copyable_v<ingest_filter>);
+
+// Every ingest stage (sampling, black color rejection, cropping, the device
+// transform and bounds checking) in a single functor, so each incoming point
+// is read once and only survivors are written. Rejected points are marked
+// with a negative index for the compaction that follows.
+struct ingest_point
+    : public thrust::unary_function<point_in_t, indexed_point_t> {
+
+  ingest_filter config;
+
+  // the top three rows of the device transform; the bottom row of an affine
+  // matrix is constant so there's no need to send it to the device
+  Eigen::Matrix<float, 3, 4, Eigen::DontAlign> transform;
+
+  ingest_point(const DeviceConfiguration &device_config,
+               const Eigen::Matrix4f &device_transform)
+      : config(device_config), transform(device_transform.topRows<3>()) {}
+
+  __host__ __device__ bool sample(int index) const {
+    return index % config.sample == 0;
+  }
+
+  __host__ __device__ bool check_color(color value) const {
+    // remove totally black values
+    if (value.r == 0 && value.g == 0 && value.b == 0)
+      return false;
+    return true;
+  }
+
+  __host__ __device__ bool check_crop(Short3 value) const {
+    auto x = config.flip_x ? -value.x : value.x;
+    auto y = config.flip_y ? value.y : -value.y;
+    auto z = config.flip_z ? -value.z : value.z;
+    return x >= config.crop_x.min && x <= config.crop_x.max &&
+           y >= config.crop_y.min && y <= config.crop_y.max &&
+           z >= config.crop_z.min && z <= config.crop_z.max;
+  }
+
+  __host__ __device__ bool check_bounds(position value) const {
+    auto x = config.flip_x ? -value.x : value.x;
+    auto y = config.flip_y ? -value.y : value.y;
+    auto z = config.flip_z ? -value.z : value.z;
+    return x >= config.bound_x.min && x <= config.bound_x.max &&
+           y >= config.bound_y.min && y <= config.bound_y.max &&
+           z >= config.bound_z.min && z <= config.bound_z.max;
+  }
+
+  __host__ __device__ indexed_point_t operator()(point_in_t point) const {
+
+    constexpr int rejected = -1;
+
+    int index = thrust::get<2>(point);
+    color col = thrust::get<1>(point);
+    Short3 pos = thrust::get<0>(point);
+
+    if (!sample(index) || !check_color(col) || !check_crop(pos)) {
+      return thrust::make_tuple(position{}, col, rejected);
+    }
+
+    // we put our position into a float vector because it allows us to
+    // transform it by other float types (e.g. matrices, quaternions)
+    Eigen::Vector3f pos_f(pos.x, pos.y, pos.z);
+
+    // every per-device transformation was folded into this matrix on the host
+    pos_f = transform.leftCols<3>() * pos_f + transform.col(3);
+
+    using pc::operators::float_to_short_rd;
+    position pos_out = {float_to_short_rd(pos_f.x()),
+                        float_to_short_rd(pos_f.y()),
+                        float_to_short_rd(pos_f.z()), 0};
+
+    if (!check_bounds(pos_out)) {
+      return thrust::make_tuple(pos_out, col, rejected);
+    }
+
+    // TODO apply color transformations here
+
+    return thrust::make_tuple(pos_out, col, index);
+  }
+};
+
+struct is_ingested {
+  __host__ __device__ bool operator()(indexed_point_t point) const {
+    return thrust::get<2>(point) >= 0;
+  }
+};
+
+} // namespace pc::devices
@@ -0,0 +1,49 @@
+#include "ingest_pipeline.h"
+#include <numbers>
+
+namespace pc::devices {
+
+Eigen::Matrix4f ingest_transform(const DeviceConfiguration &config,
+                                 const position &alignment_center,
+                                 const position &aligned_position_offset,
+                                 const Eigen::Matrix3f &auto_tilt) {
+  using namespace Eigen;
+
+  constexpr auto as_rad = [](float deg) {
+    return deg * std::numbers::pi_v<float> / 180.0f;
+  };
+
+  const Vector3f flip(config.flip_x ? -1 : 1, config.flip_y ? -1 : 1,
+                      config.flip_z ? -1 : 1);
+  const Vector3f center(alignment_center.x, alignment_center.y,
+                        alignment_center.z);
+  const Vector3f translate =
+      Vector3f(config.translate.x, config.translate.y, config.translate.z)
+          .cwiseProduct(flip);
+  const Vector3f offset =
+      Vector3f(aligned_position_offset.x, aligned_position_offset.y,
+               aligned_position_offset.z) +
+      Vector3f(config.offset.x, config.offset.y, config.offset.z);
+
+  const AngleAxisf rot_x(as_rad(config.rotation_deg.x), Vector3f::UnitX());
+  const AngleAxisf rot_y(as_rad(-config.rotation_deg.y), Vector3f::UnitY());
+  const AngleAxisf rot_z(as_rad(config.rotation_deg.z), Vector3f::UnitZ());
+  const Quaternionf rotation = rot_z * rot_y * rot_x;
+
+  // read right to left: the order each step is applied to a sensor point
+  Affine3f transform = Affine3f::Identity();
+  transform.scale(config.scale);
+  transform.translate(offset);
+  // manual rotation is centered on the alignment center
+  transform.rotate(rotation);
+  transform.translate(center);
+  transform.scale(flip);
+  transform.translate(translate);
+  // flip y and z axes for our world space
+  transform.scale(Vector3f(1, -1, -1));
+  transform.rotate(auto_tilt);
+
+  return transform.matrix();
+}
+
+} // namespace pc::devices
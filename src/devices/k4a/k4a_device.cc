@@ -1,5 +1,8 @@
 #include "k4a_device.h"
 #include "../../logger.h"
+#include "../../path.h"
+#include "../replay/recording.h"
+#include <chrono>
 #include <functional>
 #include <imgui.h>
 #include <unordered_map>
@@ -51,6 +54,21 @@ void K4ADevice::update_device_control(int *target, int value,
 
 void K4ADevice::draw_device_controls() {
 
+  auto driver = static_cast<K4ADriver *>(_driver.get());
+  if (!driver->is_recording()) {
+    if (ImGui::Button("Start recording")) {
+      using namespace std::chrono;
+      const auto timestamp =
+          duration_cast<seconds>(system_clock::now().time_since_epoch());
+      const auto file_name = fmt::format("{}_{}{}", id(), timestamp.count(),
+                                         replay::recording_extension);
+      driver->start_recording(path::get_or_create_data_directory() /
+                              "recordings" / file_name);
+    }
+  } else if (ImGui::Button("Stop recording")) {
+    driver->stop_recording();
+  }
+
   pc::gui::draw_parameters(_driver->id(),
                            parameters::struct_parameters.at(_driver->id()));
 
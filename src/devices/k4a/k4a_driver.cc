@@ -1,6 +1,8 @@
 #include "k4a_driver.h"
 #include "../../logger.h"
 #include "k4a_utils.h"
+#include <tracy/Tracy.hpp>
+#include <chrono>
 #include <future>
 #include <numeric>
 #include <set>
@@ -135,6 +137,7 @@ K4ADriver::~K4ADriver() {
   _capture_loop.join();
   _tracker_loop.join();
   _imu_loop.join();
+  stop_recording();
   stop_sensors();
   if (!lost_device) {
     _device->close();
@@ -142,6 +145,86 @@ K4ADriver::~K4ADriver() {
   free_device_memory();
 }
 
+void K4ADriver::init_device_memory() {
+  pc::logger->debug("Initialising K4A GPU device memory ({})", id());
+  _pipeline = std::make_unique<IngestPipeline>(incoming_point_count, id());
+  _device_memory_ready = true;
+  pc::logger->debug("Success");
+}
+
+void K4ADriver::free_device_memory() {
+  _device_memory_ready = false;
+  _pipeline.reset();
+  pc::logger->debug("K4A GPU Device memory freed ({})", id());
+}
+
+bool K4ADriver::process(const DeviceConfiguration &config,
+                        OperatorList operator_list) {
+
+  ZoneScopedN("K4ADriver::process");
+
+  if (!_device_memory_ready || !_open) return false;
+
+  _last_config = config;
+
+  Eigen::Matrix3f auto_tilt_value;
+  {
+    std::lock_guard lock(_auto_tilt_value_mutex);
+    auto_tilt_value = _auto_tilt_value;
+  }
+
+  // the capture thread uploads frames as they arrive, so here we only need
+  // to process whichever frame is newest
+  const auto new_frame =
+      _pipeline->process(config,
+                         ingest_transform(config, _alignment_center,
+                                          _aligned_position_offset,
+                                          auto_tilt_value),
+                         operator_list);
+  if (new_frame) _capture_time = _pipeline->capture_time();
+  return new_frame;
+}
+
+std::size_t K4ADriver::point_count() const {
+  if (!_device_memory_ready || !_open) return 0;
+  return _pipeline->point_count();
+}
+
+void K4ADriver::download(position *positions, color *colors) {
+  if (!_device_memory_ready || !_open) return;
+  _pipeline->download(positions, colors);
+}
+
+void K4ADriver::start_recording(const std::filesystem::path &file_path) {
+  stop_recording();
+  std::lock_guard lock(_recording_mutex);
+  try {
+    _recording_writer = std::make_unique<replay::RecordingWriter>(
+        file_path, incoming_point_count);
+    _recording = true;
+    pc::logger->info("Recording k4a {} to {}", id(), file_path.string());
+  } catch (const std::exception &e) {
+    pc::logger->error("Failed to start recording: {}", e.what());
+    _recording_writer.reset();
+    _recording = false;
+  }
+}
+
+void K4ADriver::stop_recording() {
+  std::unique_ptr<replay::RecordingWriter> writer;
+  {
+    std::lock_guard lock(_recording_mutex);
+    if (!_recording) return;
+    _recording = false;
+    writer = std::move(_recording_writer);
+  }
+  // finishing the file waits for its queued frames to reach the disk, so do
+  // it without holding up the capture thread
+  writer->finish();
+  pc::logger->info("Finished recording k4a {} ({} frames, {} dropped)", id(),
+                   writer->frame_count(), writer->dropped_frame_count());
+}
+
 void K4ADriver::start_sensors() {
   if (_running) return;
 
@@ -193,7 +276,7 @@ void K4ADriver::stop_sensors() {
 
 void K4ADriver::reload() {
   stop_sensors();
-  _point_cloud = {};
+  if (_device_memory_ready) _pipeline->clear();
   _skeletons.clear();
   start_sensors();
 }
@@ -306,14 +389,29 @@ void K4ADriver::capture_frames() {
       continue;
     }
 
-    std::lock_guard<std::mutex> lock(_buffer_mutex);
-
-    std::memcpy(_colors_buffer.data(), transformed_color_image.get_buffer(),
-                color_buffer_size);
-    std::memcpy(_positions_buffer.data(), point_cloud_image.get_buffer(),
-                positions_buffer_size);
+    if (_recording) {
+      ZoneScopedN("K4ADriver::record_frame");
+      std::lock_guard lock(_recording_mutex);
+      if (_recording_writer) {
+        auto capture_time = duration_cast<microseconds>(
+            steady_clock::now().time_since_epoch());
+        _recording_writer->write_frame(
+            reinterpret_cast<const Short3 *>(point_cloud_image.get_buffer()),
+            reinterpret_cast<const color *>(
+                transformed_color_image.get_buffer()),
+            capture_time);
+      }
+    }
 
-    _buffers_updated = true;
+    // stage the frame straight from the k4a images, which overlaps its
+    // transfer to the GPU with processing of the previous frame
+    if (_device_memory_ready) {
+      _pipeline->upload(
+          reinterpret_cast<const Short3 *>(point_cloud_image.get_buffer()),
+          reinterpret_cast<const color *>(
+              transformed_color_image.get_buffer()),
+          last_capture_time);
+    }
   }
 }
 
@@ -3,6 +3,8 @@
 #include "../device.h"
 #include "../driver.h"
 #include "../device_config.gen.h"
+#include "../replay/recording.h"
+#include "../ingest/ingest_pipeline.h"
 
 #include <array>
 #include <exception>
@@ -11,6 +13,8 @@
 #include <k4abt.hpp>
 #include <thread>
 #include <atomic>
+#include <filesystem>
+#include <memory>
 
 //#define EIGEN_DONT_VECTORIZE
 #include <Eigen/Geometry>
@@ -29,11 +33,6 @@ using pc::types::Uint2;
 using K4ASkeleton =
     std::array<std::pair<pc::types::position, Float4>, K4ABT_JOINT_COUNT>;
 
-// Forward declaration hides CUDA types, allowing K4ADriver to have CUDA
-// members. This prevents issues when this header is included in TUs not
-// compiled with nvcc.
-struct K4ADriverImplDeviceMemory;
-
 class K4ADriver : public Driver {
 
 public:
@@ -53,6 +52,9 @@ public:
   K4ADriver &operator=(K4ADriver &&) = delete;
 
   std::string id() const override;
+  std::chrono::steady_clock::time_point capture_time() const override {
+    return _capture_time;
+  }
   bool is_open() const override;
   bool is_running() const override;
 
@@ -64,8 +66,10 @@ public:
 
   void set_paused(bool paused) override;
 
-  PointCloud point_cloud(const DeviceConfiguration &config,
-			 OperatorList transformers = {}) override;
+  bool process(const DeviceConfiguration &config,
+               OperatorList operators = {}) override;
+  std::size_t point_count() const override;
+  void download(position *positions, color *colors) override;
 
   void start_alignment() override;
   bool is_aligning() override;
@@ -88,6 +92,14 @@ public:
   void set_gain(const int new_gain);
   int get_gain() const;
 
+  // writes every captured raw frame to a recording file that can be played
+  // back through a ReplayDriver. the file is written on its own thread, so
+  // frames are dropped from the recording rather than stalling capture if
+  // the disk can't keep up.
+  void start_recording(const std::filesystem::path &file_path);
+  void stop_recording();
+  bool is_recording() const { return _recording; };
+
   void clear_auto_tilt() {
     std::lock_guard lock(_auto_tilt_value_mutex);
     _auto_tilt_value = Eigen::Matrix3f::Identity();
@@ -105,7 +117,8 @@ private:
       sizeof(position) * incoming_point_count;
   static constexpr std::size_t colors_size = sizeof(color) * incoming_point_count;
 
-  K4ADriverImplDeviceMemory *_device_memory;
+  std::unique_ptr<IngestPipeline> _pipeline;
+  std::chrono::steady_clock::time_point _capture_time{};
   std::atomic_bool _device_memory_ready{false};
   void init_device_memory();
   void free_device_memory();
@@ -127,11 +140,9 @@ private:
   k4a::calibration _calibration;
   k4a::transformation _transformation;
 
-  std::mutex _buffer_mutex;
-  std::atomic<bool> _buffers_updated;
-
-  std::array<Short3, incoming_point_count> _positions_buffer;
-  std::array<color, incoming_point_count> _colors_buffer;
+  std::mutex _recording_mutex;
+  std::atomic_bool _recording{false};
+  std::unique_ptr<replay::RecordingWriter> _recording_writer;
 
   bool _body_tracking_enabled;
   std::thread _tracker_loop;
@@ -155,7 +166,5 @@ private:
   void run_aligner(const k4a::capture &frame);
 
   void sync_cuda();
-
-  PointCloud _point_cloud;
 };
 } // namespace pc::devices
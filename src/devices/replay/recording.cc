@@ -0,0 +1,178 @@
+#include "recording.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pc::devices::replay {
+
+RecordingWriter::RecordingWriter(const std::filesystem::path &file_path,
+                                 std::size_t point_count) {
+  if (file_path.has_parent_path()) {
+    std::filesystem::create_directories(file_path.parent_path());
+  }
+  _file.open(file_path, std::ios::binary | std::ios::trunc);
+  if (!_file) {
+    throw std::runtime_error("Unable to create recording file " +
+                             file_path.string());
+  }
+  _header.point_count = static_cast<std::uint32_t>(point_count);
+  _file.write(reinterpret_cast<const char *>(&_header), sizeof(_header));
+
+  for (std::size_t i = 0; i < buffer_count; i++) {
+    auto frame = std::make_unique<QueuedFrame>();
+    frame->positions.resize(point_count);
+    frame->colors.resize(point_count);
+    _free_frames.enqueue(std::move(frame));
+  }
+
+  _writer_thread = std::jthread(
+      [this](std::stop_token stop_token) { write_frames(stop_token); });
+}
+
+RecordingWriter::~RecordingWriter() { finish(); }
+
+void RecordingWriter::finish() {
+  if (!_writer_thread.joinable()) return;
+  _writer_thread.request_stop();
+  _writer_thread.join();
+  // the frame count in the header is only informational (readers derive it
+  // from the file size so interrupted recordings stay playable), but we keep
+  // it accurate for anyone inspecting the file
+  _file.seekp(0);
+  _file.write(reinterpret_cast<const char *>(&_header), sizeof(_header));
+}
+
+bool RecordingWriter::write_frame(const Short3 *positions, const color *colors,
+                                  std::chrono::microseconds timestamp) {
+  std::unique_ptr<QueuedFrame> frame;
+  if (!_free_frames.try_dequeue(frame)) {
+    _dropped_frame_count++;
+    return false;
+  }
+  frame->timestamp = timestamp;
+  std::copy(positions, positions + _header.point_count,
+            frame->positions.begin());
+  std::copy(colors, colors + _header.point_count, frame->colors.begin());
+  _queued_frames.enqueue(std::move(frame));
+  return true;
+}
+
+void RecordingWriter::write_frames(std::stop_token stop_token) {
+  using namespace std::chrono_literals;
+  std::unique_ptr<QueuedFrame> frame;
+  while (true) {
+    // once stopped, keep going until every queued frame is written
+    if (!_queued_frames.wait_dequeue_timed(frame, 50ms)) {
+      if (stop_token.stop_requested()) break;
+      continue;
+    }
+    const FrameHeader frame_header{.timestamp_us = frame->timestamp.count()};
+    _file.write(reinterpret_cast<const char *>(&frame_header),
+                sizeof(frame_header));
+    _file.write(reinterpret_cast<const char *>(frame->positions.data()),
+                _header.point_count * sizeof(Short3));
+    _file.write(reinterpret_cast<const char *>(frame->colors.data()),
+                _header.point_count * sizeof(color));
+    _header.frame_count++;
+    _written_frame_count++;
+    _free_frames.enqueue(std::move(frame));
+  }
+}
+
+RecordingReader::RecordingReader(const std::filesystem::path &file_path) {
+  const auto fail = [&](std::string_view reason) {
+    release();
+    throw std::runtime_error(std::string(reason) + ": " + file_path.string());
+  };
+
+#ifdef _WIN32
+  _file_handle =
+      CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (_file_handle == INVALID_HANDLE_VALUE) {
+    _file_handle = nullptr;
+    fail("Unable to open recording");
+  }
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(_file_handle, &file_size);
+  _size = static_cast<std::size_t>(file_size.QuadPart);
+  if (_size < sizeof(RecordingHeader)) fail("Recording is truncated");
+  _mapping_handle =
+      CreateFileMappingW(_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mapping_handle == nullptr) fail("Unable to map recording");
+  _data = static_cast<const std::byte *>(
+      MapViewOfFile(_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+  if (_data == nullptr) fail("Unable to map recording");
+#else
+  _file_descriptor = open(file_path.c_str(), O_RDONLY);
+  if (_file_descriptor == -1) fail("Unable to open recording");
+  struct stat file_stat;
+  fstat(_file_descriptor, &file_stat);
+  _size = static_cast<std::size_t>(file_stat.st_size);
+  if (_size < sizeof(RecordingHeader)) fail("Recording is truncated");
+  auto mapping =
+      mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file_descriptor, 0);
+  if (mapping == MAP_FAILED) fail("Unable to map recording");
+  // frames are mostly read in order
+  madvise(mapping, _size, MADV_SEQUENTIAL);
+  _data = static_cast<const std::byte *>(mapping);
+#endif
+
+  RecordingHeader header;
+  std::memcpy(&header, _data, sizeof(header));
+  if (header.magic != recording_magic) fail("Not a pointcaster recording");
+  if (header.version != recording_version) {
+    fail("Unsupported recording version");
+  }
+
+  _point_count = header.point_count;
+  _frame_count =
+      (_size - sizeof(RecordingHeader)) / frame_chunk_size(_point_count);
+}
+
+RecordingReader::~RecordingReader() { release(); }
+
+void RecordingReader::release() {
+#ifdef _WIN32
+  if (_data) UnmapViewOfFile(_data);
+  if (_mapping_handle) CloseHandle(_mapping_handle);
+  if (_file_handle) CloseHandle(_file_handle);
+  _mapping_handle = nullptr;
+  _file_handle = nullptr;
+#else
+  if (_data) munmap(const_cast<std::byte *>(_data), _size);
+  if (_file_descriptor != -1) close(_file_descriptor);
+  _file_descriptor = -1;
+#endif
+  _data = nullptr;
+}
+
+RecordingReader::Frame RecordingReader::frame(std::size_t index) const {
+  if (index >= _frame_count) {
+    throw std::out_of_range("Recording frame index out of range");
+  }
+  const auto chunk = _data + sizeof(RecordingHeader) +
+                     index * frame_chunk_size(_point_count);
+
+  FrameHeader frame_header;
+  std::memcpy(&frame_header, chunk, sizeof(frame_header));
+
+  const auto positions = chunk + sizeof(FrameHeader);
+  const auto colors = positions + _point_count * sizeof(Short3);
+
+  return {.timestamp = std::chrono::microseconds(frame_header.timestamp_us),
+          .positions = reinterpret_cast<const Short3 *>(positions),
+          .colors = reinterpret_cast<const color *>(colors)};
+}
+
+} // namespace pc::devices::replay
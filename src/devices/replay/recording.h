@@ -0,0 +1,145 @@
+#pragma once
+
+#include "../../structs.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace pc::devices::replay {
+
+using pc::types::color;
+using pc::types::Short3;
+
+// Recordings hold raw organised frames exactly as a sensor driver captures
+// them: a Short3 position buffer and a BGRA color buffer per frame.
+//
+// The file is a header followed by fixed-size frame chunks, so any frame can
+// be addressed directly inside a memory map without parsing the frames
+// before it:
+//
+//   RecordingHeader
+//   [FrameHeader][Short3 * point_count][color * point_count]
+//   [FrameHeader][Short3 * point_count][color * point_count]
+//   ...
+
+inline constexpr std::array<char, 4> recording_magic{'P', 'C', 'R', 'C'};
+inline constexpr std::uint32_t recording_version = 1;
+inline constexpr auto recording_extension = ".pcrec";
+
+struct RecordingHeader {
+  std::array<char, 4> magic = recording_magic;
+  std::uint32_t version = recording_version;
+  std::uint32_t point_count = 0;
+  std::uint32_t frame_count = 0;
+};
+
+struct FrameHeader {
+  // capture time of the frame in microseconds, relative to an arbitrary
+  // epoch. only differences between frames are meaningful.
+  std::int64_t timestamp_us = 0;
+};
+
+inline constexpr std::size_t frame_chunk_size(std::size_t point_count) {
+  return sizeof(FrameHeader) + point_count * (sizeof(Short3) + sizeof(color));
+}
+
+// Frames are copied into one of a few preallocated buffers and written to
+// disk on the writer's own thread, so capture threads never wait on file
+// I/O. If the disk falls so far behind that every buffer is still queued,
+// new frames are dropped instead of stalling capture.
+class RecordingWriter {
+public:
+  static constexpr std::size_t buffer_count = 8;
+
+  // throws std::runtime_error if the file can't be created
+  RecordingWriter(const std::filesystem::path &file_path,
+                  std::size_t point_count);
+  ~RecordingWriter();
+
+  RecordingWriter(const RecordingWriter &) = delete;
+  RecordingWriter &operator=(const RecordingWriter &) = delete;
+
+  // queues a copy of the frame for writing. returns false if the frame was
+  // dropped because every buffer is waiting to be written.
+  bool write_frame(const Short3 *positions, const color *colors,
+                   std::chrono::microseconds timestamp);
+
+  // write every queued frame and complete the file. frames can't be
+  // written afterwards. called by the destructor if needed.
+  void finish();
+
+  std::size_t frame_count() const { return _written_frame_count; }
+  std::size_t dropped_frame_count() const { return _dropped_frame_count; }
+
+private:
+  struct QueuedFrame {
+    std::chrono::microseconds timestamp;
+    std::vector<Short3> positions;
+    std::vector<color> colors;
+  };
+
+  std::ofstream _file;
+  // the frame count is only updated by the writer thread
+  RecordingHeader _header;
+
+  std::atomic<std::size_t> _written_frame_count{0};
+  std::atomic<std::size_t> _dropped_frame_count{0};
+
+  moodycamel::ConcurrentQueue<std::unique_ptr<QueuedFrame>> _free_frames;
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<QueuedFrame>>
+      _queued_frames;
+
+  // declared last so that it stops before the queues are destroyed
+  std::jthread _writer_thread;
+  void write_frames(std::stop_token stop_token);
+};
+
+class RecordingReader {
+public:
+  struct Frame {
+    std::chrono::microseconds timestamp;
+    const Short3 *positions;
+    const color *colors;
+  };
+
+  // memory maps the file at file_path, throwing std::runtime_error if it
+  // can't be opened or isn't a valid recording
+  explicit RecordingReader(const std::filesystem::path &file_path);
+  ~RecordingReader();
+
+  RecordingReader(const RecordingReader &) = delete;
+  RecordingReader &operator=(const RecordingReader &) = delete;
+
+  std::size_t frame_count() const { return _frame_count; }
+  std::size_t point_count() const { return _point_count; }
+
+  // frame data points directly into the mapping and remains valid for the
+  // lifetime of the reader
+  Frame frame(std::size_t index) const;
+
+private:
+  std::size_t _frame_count = 0;
+  std::size_t _point_count = 0;
+
+  const std::byte *_data = nullptr;
+  std::size_t _size = 0;
+
+#ifdef _WIN32
+  void *_file_handle = nullptr;
+  void *_mapping_handle = nullptr;
+#else
+  int _file_descriptor = -1;
+#endif
+
+  void release();
+};
+
+} // namespace pc::devices::replay
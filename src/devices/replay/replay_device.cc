@@ -0,0 +1,41 @@
+#include "replay_device.h"
+#include "../../gui/widgets.h"
+#include "../../logger.h"
+#include "../../parameters.h"
+#include <imgui.h>
+
+namespace pc::devices {
+
+ReplayDevice::ReplayDevice(DeviceConfiguration config) : Device(config) {
+  pc::logger->info("Initialising ReplayDevice");
+
+  _driver = std::make_unique<ReplayDriver>(config);
+
+  name = "Replay " + _driver->id();
+  is_sensor = false;
+
+  count++;
+
+  parameters::declare_parameters(_driver->id(), _config);
+}
+
+ReplayDevice::~ReplayDevice() {
+  pc::logger->info("Closing {}", name);
+  count--;
+}
+
+std::string ReplayDevice::id() { return _driver->id(); }
+
+void ReplayDevice::draw_device_controls() {
+  auto driver = static_cast<ReplayDriver *>(_driver.get());
+
+  ImGui::Dummy({8, 0});
+  ImGui::SameLine();
+  ImGui::TextDisabled("Frame %zu / %zu", driver->current_frame() + 1,
+                      driver->frame_count());
+
+  pc::gui::draw_parameters(_driver->id(),
+                           parameters::struct_parameters.at(_driver->id()));
+}
+
+} // namespace pc::devices
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../device.h"
+#include "replay_driver.h"
+#include <atomic>
+
+namespace pc::devices {
+
+class ReplayDevice : public Device {
+public:
+  ReplayDevice(DeviceConfiguration config);
+  ~ReplayDevice();
+
+  ReplayDevice(const ReplayDevice &) = delete;
+  ReplayDevice &operator=(const ReplayDevice &) = delete;
+  ReplayDevice(ReplayDevice &&) = delete;
+  ReplayDevice &operator=(ReplayDevice &&) = delete;
+
+  std::string id() override;
+
+  void draw_device_controls() override;
+
+  static inline std::atomic<std::size_t> count;
+};
+
+} // namespace pc::devices
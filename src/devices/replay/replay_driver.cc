@@ -0,0 +1,205 @@
+#include "replay_driver.h"
+#include "../../logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <functional>
+#include <system_error>
+#include <tracy/Tracy.hpp>
+
+namespace pc::devices {
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+ReplayDriver::ReplayDriver(const DeviceConfiguration &config)
+    : _file_path(config.replay.file_path), _replay_config(config.replay) {
+
+  // recordings with the same name can live in different directories, so
+  // the id carries a hash of where the file is as well as its name
+  std::error_code error;
+  auto absolute_path = std::filesystem::weakly_canonical(_file_path, error);
+  if (error) absolute_path = std::filesystem::absolute(_file_path);
+  const auto path_hash =
+      std::hash<std::string>{}(absolute_path.generic_string()) & 0xffffffff;
+  _id = fmt::format("{}_{:08x}", _file_path.stem().string(), path_hash);
+  device_index = active_count;
+
+  pc::logger->info("Opening replay driver ({})", _file_path.string());
+
+  try {
+    _recording = std::make_unique<replay::RecordingReader>(_file_path);
+    if (_recording->frame_count() == 0) {
+      throw std::runtime_error("Recording contains no frames");
+    }
+    _pipeline = std::make_unique<IngestPipeline>(_recording->point_count(),
+                                                 _id);
+  } catch (const std::exception &e) {
+    pc::logger->error("Failed to open recording: {}", e.what());
+    _recording.reset();
+    lost_device = true;
+    return;
+  }
+
+  pc::logger->info("Loaded {} frames from '{}'", _recording->frame_count(),
+                   _id);
+
+  active_count++;
+  _open = true;
+
+  start_sensors();
+
+  _playback_loop = std::jthread([this](auto stop_token) { playback(stop_token); });
+}
+
+ReplayDriver::~ReplayDriver() {
+  pc::logger->info("Closing replay driver ({})", id());
+  _playback_loop = {};
+  if (_open) active_count--;
+  _open = false;
+}
+
+std::string ReplayDriver::id() const { return _id; }
+
+bool ReplayDriver::is_open() const { return _open; }
+
+bool ReplayDriver::is_running() const { return _running; }
+
+void ReplayDriver::start_sensors() {
+  if (_open) _running = true;
+}
+
+void ReplayDriver::stop_sensors() { _running = false; }
+
+void ReplayDriver::reload() { _restart_requested = true; }
+
+void ReplayDriver::set_paused(bool paused) { _paused = paused; }
+
+std::size_t ReplayDriver::frame_count() const {
+  return _recording ? _recording->frame_count() : 0;
+}
+
+void ReplayDriver::playback(std::stop_token stop_token) {
+
+  const auto frame_count = _recording->frame_count();
+  const auto recording_start = _recording->frame(0).timestamp;
+
+  // real-time playback schedules each frame relative to a steady clock
+  // anchor, which gets reset whenever the schedule is interrupted (pausing,
+  // looping, or changing speed)
+  auto anchor = steady_clock::now();
+  float anchor_speed = 0;
+  bool needs_anchor = true;
+
+  const auto frame_offset = [&](std::size_t index, float speed) {
+    const duration<double, std::micro> recording_offset =
+        _recording->frame(index).timestamp - recording_start;
+    return duration_cast<steady_clock::duration>(recording_offset / speed);
+  };
+
+  // the first frame is available straight away
+  upload_frame(0);
+
+  while (!stop_token.stop_requested()) {
+
+    if (_restart_requested.exchange(false)) {
+      _frame_index = 0;
+      upload_frame(0);
+      needs_anchor = true;
+      continue;
+    }
+
+    if (!_running || _paused) {
+      std::this_thread::sleep_for(10ms);
+      needs_anchor = true;
+      continue;
+    }
+
+    ReplayConfiguration config;
+    {
+      std::lock_guard lock(_config_mutex);
+      config = _replay_config;
+    }
+    const auto speed = std::max(config.speed, 0.01f);
+
+    auto next_index = _frame_index + 1;
+    if (next_index >= frame_count) {
+      if (!config.loop) {
+        std::this_thread::sleep_for(10ms);
+        continue;
+      }
+      next_index = 0;
+      needs_anchor = true;
+    }
+
+    if ((PlaybackMode)config.playback_mode == PlaybackMode::AsFastAsPossible) {
+      // hand over the next frame as soon as the last one was consumed
+      if (_buffers_updated) {
+        std::this_thread::sleep_for(100us);
+        continue;
+      }
+      needs_anchor = true;
+    } else {
+      if (needs_anchor || speed != anchor_speed) {
+        // after looping, frame 0 plays immediately, otherwise we continue on
+        // from the frame currently being shown
+        const auto anchor_index = next_index == 0 ? 0 : _frame_index.load();
+        anchor = steady_clock::now() - frame_offset(anchor_index, speed);
+        anchor_speed = speed;
+        needs_anchor = false;
+      }
+      // don't oversleep so that pausing and stopping stay responsive
+      const auto frame_time = anchor + frame_offset(next_index, speed);
+      if (frame_time - steady_clock::now() > 10ms) {
+        std::this_thread::sleep_for(10ms);
+        continue;
+      }
+      std::this_thread::sleep_until(frame_time);
+    }
+
+    _frame_index = next_index;
+    upload_frame(next_index);
+  }
+}
+
+void ReplayDriver::upload_frame(std::size_t index) {
+  // frames are uploaded straight out of the memory mapped recording, on the
+  // playback thread like a sensor's capture thread, so the upload wakes the
+  // frame bus when the frame is due rather than when it next polls
+  const auto frame = _recording->frame(index);
+  _pipeline->upload(frame.positions, frame.colors);
+  _buffers_updated = true;
+}
+
+bool ReplayDriver::process(const DeviceConfiguration &config,
+                           OperatorList operators) {
+  ZoneScopedN("ReplayDriver::process");
+
+  {
+    std::lock_guard lock(_config_mutex);
+    _replay_config = config.replay;
+  }
+
+  std::lock_guard lock(_pipeline_mutex);
+
+  if (!_open) return false;
+
+  if (!_pipeline->process(config, ingest_transform(config), operators)) {
+    return false;
+  }
+  _buffers_updated = false;
+  _capture_time = _pipeline->capture_time();
+  return true;
+}
+
+std::size_t ReplayDriver::point_count() const {
+  std::lock_guard lock(_pipeline_mutex);
+  return _open ? _pipeline->point_count() : 0;
+}
+
+void ReplayDriver::download(position *positions, color *colors) {
+  std::lock_guard lock(_pipeline_mutex);
+  if (_open) _pipeline->download(positions, colors);
+}
+
+} // namespace pc::devices
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../device_config.gen.h"
+#include "../driver.h"
+#include "../ingest/ingest_pipeline.h"
+#include "recording.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace pc::devices {
+
+enum class PlaybackMode { RealTime = 0, AsFastAsPossible = 1 };
+
+// A Driver that plays back a recording made with K4ADriver::start_recording,
+// pushing the recorded raw frames through the same processing pipeline as a
+// live sensor. Useful for profiling and regression testing without hardware.
+class ReplayDriver : public Driver {
+
+public:
+  static inline std::atomic<unsigned int> active_count = 0;
+
+  ReplayDriver(const DeviceConfiguration &config);
+  ~ReplayDriver();
+
+  ReplayDriver(const ReplayDriver &) = delete;
+  ReplayDriver &operator=(const ReplayDriver &) = delete;
+  ReplayDriver(ReplayDriver &&) = delete;
+  ReplayDriver &operator=(ReplayDriver &&) = delete;
+
+  std::string id() const override;
+  std::chrono::steady_clock::time_point capture_time() const override {
+    return _capture_time;
+  }
+  bool is_open() const override;
+  bool is_running() const override;
+
+  void start_sensors() override;
+  void stop_sensors() override;
+  void reload() override;
+
+  void set_paused(bool paused) override;
+
+  bool process(const DeviceConfiguration &config,
+               OperatorList operators = {}) override;
+  std::size_t point_count() const override;
+  void download(position *positions, color *colors) override;
+
+  // recordings don't carry body tracking data, so there's nothing to align
+  void start_alignment() override {}
+  bool is_aligning() override { return false; }
+  bool is_aligned() override { return false; }
+
+  std::size_t frame_count() const;
+  std::size_t current_frame() const { return _frame_index; }
+
+private:
+  std::string _id;
+  std::filesystem::path _file_path;
+
+  std::unique_ptr<replay::RecordingReader> _recording;
+  std::unique_ptr<IngestPipeline> _pipeline;
+  std::chrono::steady_clock::time_point _capture_time{};
+
+  std::atomic_bool _open{false};
+  std::atomic_bool _running{false};
+  std::atomic_bool _paused{false};
+
+  std::mutex _config_mutex;
+  ReplayConfiguration _replay_config;
+
+  std::atomic<std::size_t> _frame_index{0};
+  // set when the playback thread uploads a frame, and cleared once it has
+  // been processed
+  std::atomic_bool _buffers_updated{false};
+  std::atomic_bool _restart_requested{false};
+
+  mutable std::mutex _pipeline_mutex;
+
+  std::jthread _playback_loop;
+  void playback(std::stop_token stop_token);
+  void upload_frame(std::size_t index);
+};
+
+} // namespace pc::devices
@@ -0,0 +1,46 @@
+#include "synthetic_device.h"
+#include "../../gui/widgets.h"
+#include "../../logger.h"
+#include "../../parameters.h"
+#include <imgui.h>
+
+namespace pc::devices {
+
+SyntheticDevice::SyntheticDevice(DeviceConfiguration config,
+                                 std::string_view target_id)
+    : Device(config) {
+  pc::logger->info("Initialising SyntheticDevice");
+
+  // sessions reload these from their saved config, so make sure the flag
+  // that routes them back here is always set
+  _config.synthetic.enabled = true;
+
+  _driver = std::make_unique<SyntheticDriver>(_config, target_id);
+
+  name = "Synthetic " + std::to_string(_driver->device_index);
+  is_sensor = false;
+
+  count++;
+
+  parameters::declare_parameters(_driver->id(), _config);
+}
+
+SyntheticDevice::~SyntheticDevice() {
+  pc::logger->info("Closing {}", name);
+  count--;
+}
+
+std::string SyntheticDevice::id() { return _driver->id(); }
+
+void SyntheticDevice::draw_device_controls() {
+  auto driver = static_cast<SyntheticDriver *>(_driver.get());
+
+  ImGui::Dummy({8, 0});
+  ImGui::SameLine();
+  ImGui::TextDisabled("Generated %zu frames", driver->frames_generated());
+
+  pc::gui::draw_parameters(_driver->id(),
+                           parameters::struct_parameters.at(_driver->id()));
+}
+
+} // namespace pc::devices
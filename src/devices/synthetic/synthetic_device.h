@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../device.h"
+#include "synthetic_driver.h"
+#include <atomic>
+#include <string_view>
+
+namespace pc::devices {
+
+class SyntheticDevice : public Device {
+public:
+  SyntheticDevice(DeviceConfiguration config, std::string_view target_id = "");
+  ~SyntheticDevice();
+
+  SyntheticDevice(const SyntheticDevice &) = delete;
+  SyntheticDevice &operator=(const SyntheticDevice &) = delete;
+  SyntheticDevice(SyntheticDevice &&) = delete;
+  SyntheticDevice &operator=(SyntheticDevice &&) = delete;
+
+  std::string id() override;
+
+  void draw_device_controls() override;
+
+  static inline std::atomic<std::size_t> count;
+};
+
+} // namespace pc::devices
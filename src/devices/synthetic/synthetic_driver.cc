@@ -0,0 +1,233 @@
+#include "synthetic_driver.h"
+#include "../../logger.h"
+#include "../../utils/worker_pool.h"
+#include "../../uuid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <tracy/Tracy.hpp>
+
+namespace pc::devices {
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+SyntheticDriver::SyntheticDriver(const DeviceConfiguration &config,
+                                 std::string_view target_id)
+    : _synthetic_config(config.synthetic),
+      _positions_buffer(max_point_count), _colors_buffer(max_point_count) {
+
+  device_index = active_count;
+  // the active count goes down as devices are removed, so it can't tell new
+  // devices apart from ones that are already open or saved in the session
+  _id = target_id.empty() ? "synthetic_" + pc::uuid::word()
+                          : std::string(target_id);
+
+  pc::logger->info("Opening synthetic driver ({})", _id);
+
+  _pipeline = std::make_unique<IngestPipeline>(max_point_count, _id);
+
+  active_count++;
+  _open = true;
+
+  start_sensors();
+
+  _generator_loop =
+      std::jthread([this](auto stop_token) { generate(stop_token); });
+}
+
+SyntheticDriver::~SyntheticDriver() {
+  pc::logger->info("Closing synthetic driver ({})", id());
+  _generator_loop = {};
+  active_count--;
+  _open = false;
+}
+
+std::string SyntheticDriver::id() const { return _id; }
+
+bool SyntheticDriver::is_open() const { return _open; }
+
+bool SyntheticDriver::is_running() const { return _running; }
+
+void SyntheticDriver::start_sensors() {
+  if (_open) _running = true;
+}
+
+void SyntheticDriver::stop_sensors() { _running = false; }
+
+void SyntheticDriver::reload() { _frames_generated = 0; }
+
+void SyntheticDriver::set_paused(bool paused) { _paused = paused; }
+
+void SyntheticDriver::generate(std::stop_token stop_token) {
+
+  const auto start_time = steady_clock::now();
+  auto next_frame_time = start_time;
+
+  while (!stop_token.stop_requested()) {
+
+    if (!_running || _paused) {
+      std::this_thread::sleep_for(10ms);
+      next_frame_time = steady_clock::now();
+      continue;
+    }
+
+    SyntheticConfiguration config;
+    {
+      std::lock_guard lock(_config_mutex);
+      config = _synthetic_config;
+    }
+
+    const duration<float> elapsed = steady_clock::now() - start_time;
+    generate_frame(config, elapsed.count() * config.motion_speed);
+
+    _pipeline->upload(_positions_buffer.data(), _colors_buffer.data());
+    _frames_generated++;
+
+    // if generation falls behind the target frame rate, start the schedule
+    // again from now instead of trying to catch up with a burst of frames
+    const auto frame_duration = duration_cast<steady_clock::duration>(
+        duration<float>(1.0f / std::max(config.frame_rate, 1.0f)));
+    next_frame_time += frame_duration;
+    const auto now = steady_clock::now();
+    if (next_frame_time < now) next_frame_time = now;
+    std::this_thread::sleep_until(next_frame_time);
+  }
+}
+
+namespace {
+
+// cheap integer hash for repeatable per-point noise
+constexpr std::uint32_t hash(std::uint32_t value) {
+  value ^= value >> 16;
+  value *= 0x7feb352d;
+  value ^= value >> 15;
+  value *= 0x846ca68b;
+  value ^= value >> 16;
+  return value;
+}
+
+constexpr float unit_noise(std::uint32_t seed) {
+  return (hash(seed) & 0xffffff) / float(0xffffff);
+}
+
+} // namespace
+
+void SyntheticDriver::generate_frame(const SyntheticConfiguration &config,
+                                     float time) {
+  ZoneScopedN("SyntheticDriver::generate_frame");
+
+  using std::numbers::pi_v;
+
+  const auto point_count = std::clamp<std::size_t>(config.point_count, 1,
+                                                   max_point_count);
+  const auto pattern = static_cast<MotionPattern>(config.motion_pattern);
+  const auto frame = static_cast<std::uint32_t>(_frames_generated.load());
+
+  // points are laid out on a square grid so every pattern can address them
+  // by normalised (u, v) coordinates
+  const auto side =
+      std::max<std::size_t>(2, std::ceil(std::sqrt(float(point_count))));
+
+  // positions are produced in K4A camera space (millimetres, y down, z away
+  // from the sensor) so they're treated exactly like real sensor input
+  const auto generate_point = [&](std::size_t i) {
+    const float u = float(i % side) / (side - 1);
+    const float v = float(i / side) / (side - 1);
+
+    float x = 0, y = 0, z = 0;
+    switch (pattern) {
+    case MotionPattern::Orbit: {
+      // four spheres circling the middle of the capture volume
+      constexpr int sphere_count = 4;
+      constexpr float sphere_radius = 350;
+      constexpr float orbit_radius = 900;
+      const auto sphere = i % sphere_count;
+      const float orbit_angle =
+          time + sphere * (2 * pi_v<float> / sphere_count);
+      const float theta = u * 2 * pi_v<float>;
+      const float phi = v * pi_v<float>;
+      x = orbit_radius * std::cos(orbit_angle) +
+          sphere_radius * std::sin(phi) * std::cos(theta);
+      y = sphere_radius * std::cos(phi);
+      z = 2500 + orbit_radius * std::sin(orbit_angle) +
+          sphere_radius * std::sin(phi) * std::sin(theta);
+      break;
+    }
+    case MotionPattern::Noise: {
+      const auto seed = static_cast<std::uint32_t>(i) * 3 + frame * 0x9e3779b9;
+      x = (unit_noise(seed) - 0.5f) * 3000;
+      y = (unit_noise(seed + 1) - 0.5f) * 2000;
+      z = 1500 + unit_noise(seed + 2) * 2000;
+      break;
+    }
+    case MotionPattern::Static:
+    case MotionPattern::Wave:
+    default: {
+      const float t = pattern == MotionPattern::Static ? 0 : time;
+      x = (u - 0.5f) * 3000;
+      y = (v - 0.5f) * 3000;
+      z = 2500 + 300 * std::sin(u * 4 * pi_v<float> + t) *
+                     std::cos(v * 4 * pi_v<float> + t * 0.7f);
+      break;
+    }
+    }
+
+    _positions_buffer[i] = {static_cast<short>(x), static_cast<short>(y),
+                                 static_cast<short>(z)};
+
+    // totally black points are dropped by the input filter, so keep every
+    // channel above zero
+    auto &c = _colors_buffer[i];
+    c.r = static_cast<std::uint8_t>(16 + u * 239);
+    c.g = static_cast<std::uint8_t>(16 + v * 239);
+    c.b = static_cast<std::uint8_t>(16 + (1 - u) * 239);
+    c.a = 255;
+  };
+
+  constexpr std::size_t chunk_size = 16384;
+  const auto chunk_count = (point_count + chunk_size - 1) / chunk_size;
+  pc::utils::worker_pool().parallel_for(chunk_count, [&](std::size_t chunk) {
+    const auto begin = chunk * chunk_size;
+    const auto end = std::min(begin + chunk_size, point_count);
+    for (auto i = begin; i < end; i++) generate_point(i);
+  });
+
+  // anything past the configured count is blanked so the pipeline skips it
+  std::fill(_colors_buffer.begin() + point_count,
+            _colors_buffer.end(), color{});
+}
+
+bool SyntheticDriver::process(const DeviceConfiguration &config,
+                              OperatorList operators) {
+  ZoneScopedN("SyntheticDriver::process");
+
+  {
+    std::lock_guard lock(_config_mutex);
+    _synthetic_config = config.synthetic;
+  }
+
+  std::lock_guard lock(_pipeline_mutex);
+
+  if (!_open) return false;
+
+  if (!_pipeline->process(config, ingest_transform(config), operators)) {
+    return false;
+  }
+  _capture_time = _pipeline->capture_time();
+  return true;
+}
+
+std::size_t SyntheticDriver::point_count() const {
+  std::lock_guard lock(_pipeline_mutex);
+  return _open ? _pipeline->point_count() : 0;
+}
+
+void SyntheticDriver::download(position *positions, color *colors) {
+  std::lock_guard lock(_pipeline_mutex);
+  if (_open) _pipeline->download(positions, colors);
+}
+
+} // namespace pc::devices
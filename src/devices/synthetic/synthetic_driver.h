@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../device_config.gen.h"
+#include "../driver.h"
+#include "../ingest/ingest_pipeline.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace pc::devices {
+
+enum class MotionPattern { Wave = 0, Orbit = 1, Noise = 2, Static = 3 };
+
+// A Driver that procedurally generates K4A-shaped frames with no hardware
+// attached. Frames go through the same processing pipeline as a live sensor,
+// so any number of these can stand in for real devices when measuring how
+// synthesis, the operators and the radio scale with sensor count.
+class SyntheticDriver : public Driver {
+
+public:
+  // matches K4ADriver::incoming_point_count (512x512 NFOV unbinned)
+  static constexpr std::size_t max_point_count = 512 * 512;
+
+  static inline std::atomic<unsigned int> active_count = 0;
+
+  SyntheticDriver(const DeviceConfiguration &config,
+                  std::string_view target_id = "");
+  ~SyntheticDriver();
+
+  SyntheticDriver(const SyntheticDriver &) = delete;
+  SyntheticDriver &operator=(const SyntheticDriver &) = delete;
+  SyntheticDriver(SyntheticDriver &&) = delete;
+  SyntheticDriver &operator=(SyntheticDriver &&) = delete;
+
+  std::string id() const override;
+  std::chrono::steady_clock::time_point capture_time() const override {
+    return _capture_time;
+  }
+  bool is_open() const override;
+  bool is_running() const override;
+
+  void start_sensors() override;
+  void stop_sensors() override;
+  void reload() override;
+
+  void set_paused(bool paused) override;
+
+  bool process(const DeviceConfiguration &config,
+               OperatorList operators = {}) override;
+  std::size_t point_count() const override;
+  void download(position *positions, color *colors) override;
+
+  // there are no bodies in generated frames, so nothing to align
+  void start_alignment() override {}
+  bool is_aligning() override { return false; }
+  bool is_aligned() override { return false; }
+
+  std::size_t frames_generated() const { return _frames_generated; }
+
+private:
+  std::string _id;
+
+  std::unique_ptr<IngestPipeline> _pipeline;
+  std::chrono::steady_clock::time_point _capture_time{};
+
+  std::atomic_bool _open{false};
+  std::atomic_bool _running{false};
+  std::atomic_bool _paused{false};
+
+  std::mutex _config_mutex;
+  SyntheticConfiguration _synthetic_config;
+
+  // the generator fills these and uploads them to the pipeline itself, so
+  // point_cloud never waits on generation
+  std::vector<Short3> _positions_buffer;
+  std::vector<color> _colors_buffer;
+
+  std::atomic<std::size_t> _frames_generated{0};
+
+  mutable std::mutex _pipeline_mutex;
+
+  std::jthread _generator_loop;
+  void generate(std::stop_token stop_token);
+  void generate_frame(const SyntheticConfiguration &config, float time);
+};
+
+} // namespace pc::devices
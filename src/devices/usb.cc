@@ -113,7 +113,9 @@ int UsbMonitor::handle_hotplug_event(struct libusb_context *ctx,
 
   using pc::devices::DeviceType;
   using pc::devices::DeviceConfiguration;
+#if WITH_K4A
   using pc::devices::K4ADevice;
+#endif
 
   auto device_type = it->second;
 
@@ -127,6 +129,7 @@ int UsbMonitor::handle_hotplug_event(struct libusb_context *ctx,
       if (device->lost_device()) lost_devices.push_back(device);
     }
 
+#if WITH_K4A
     if (device_type == DeviceType::K4A) {
       pc::logger->debug("K4A device plugged in");
 
@@ -195,6 +198,7 @@ int UsbMonitor::handle_hotplug_event(struct libusb_context *ctx,
 	return 0;
       }
     }
+#endif
 
   } else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
 
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../structs.h"
+#include "background_operator.gen.h"
+#include "frame_history.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thrust/device_vector.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/host_vector.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/remove.h>
+#include <type_traits>
+
+namespace pc::operators {
+
+// the mean position a depth pixel landed at while the model was learning
+struct BackgroundPixel {
+  float x, y, z;
+  std::uint32_t sample_count;
+};
+
+struct BackgroundModel {
+  std::uint32_t learned_frames = 0;
+  // the configuration's relearn_generation when learning last started
+  int relearn_generation = 0;
+  // the model is only kept in the memory of one backend at a time
+  bool last_on_device = false;
+  thrust::device_vector<BackgroundPixel> device_pixels;
+  thrust::host_vector<BackgroundPixel> host_pixels;
+};
+
+struct learn_background {
+  BackgroundPixel *pixels;
+  int pixel_count;
+
+  __host__ __device__ void operator()(indexed_point_t point) const {
+    const int pixel = thrust::get<2>(point);
+    if (pixel < 0 || pixel >= pixel_count) return;
+    const auto pos = thrust::get<0>(point);
+    // each pixel appears at most once per frame, so there are no races
+    auto &background = pixels[pixel];
+    const float n = static_cast<float>(++background.sample_count);
+    background.x += (pos.x - background.x) / n;
+    background.y += (pos.y - background.y) / n;
+    background.z += (pos.z - background.z) / n;
+  }
+};
+
+struct is_background {
+  const BackgroundPixel *pixels;
+  int pixel_count;
+  std::uint32_t min_sample_count;
+  float tolerance_squared;
+
+  __host__ __device__ bool operator()(indexed_point_t point) const {
+    const int pixel = thrust::get<2>(point);
+    if (pixel < 0 || pixel >= pixel_count) return false;
+    const auto &background = pixels[pixel];
+    // pixels that rarely returned a point while learning (e.g. through a
+    // doorway) have no reliable background
+    if (background.sample_count < min_sample_count) return false;
+    const auto pos = thrust::get<0>(point);
+    const float dx = pos.x - background.x;
+    const float dy = pos.y - background.y;
+    const float dz = pos.z - background.z;
+    return dx * dx + dy * dy + dz * dz <= tolerance_squared;
+  }
+};
+
+// Learns the background for the first learning_frames frames, leaving the
+// points untouched, then removes every point close to its pixel's
+// background. Returns the new end.
+template <typename ExecutionPolicy, typename Iterator>
+Iterator run_background(const ExecutionPolicy &policy, BackgroundModel &model,
+                        std::size_t pixel_count, Iterator begin, Iterator end,
+                        const BackgroundOperatorConfiguration &config) {
+  constexpr bool on_device =
+      std::is_same_v<thrust::iterator_system_t<Iterator>,
+                     thrust::device_system_tag>;
+  auto &pixels = [&]() -> auto & {
+    if constexpr (on_device) return model.device_pixels;
+    else return model.host_pixels;
+  }();
+
+  // storage is sized once, so learning again never reallocates
+  const bool resized = pixels.size() != pixel_count;
+  if (resized) pixels.resize(pixel_count);
+  // the configuration is shared by every device, so relearning is only
+  // ever requested through it, never acknowledged
+  const bool relearn = model.relearn_generation != config.relearn_generation;
+  if (resized || relearn || model.last_on_device != on_device) {
+    thrust::fill(policy, pixels.begin(), pixels.end(), BackgroundPixel{});
+    model.learned_frames = 0;
+    model.last_on_device = on_device;
+    model.relearn_generation = config.relearn_generation;
+  }
+
+  const auto pixels_data = thrust::raw_pointer_cast(pixels.data());
+  const auto learning_frames =
+      static_cast<std::uint32_t>(std::max(config.learning_frames, 1));
+
+  if (model.learned_frames < learning_frames) {
+    thrust::for_each(policy, begin, end,
+                     learn_background{pixels_data,
+                                      static_cast<int>(pixel_count)});
+    model.learned_frames++;
+    return end;
+  }
+
+  return thrust::remove_if(
+      policy, begin, end,
+      is_background{pixels_data, static_cast<int>(pixel_count),
+                    std::max(learning_frames / 2, 1u),
+                    config.tolerance * config.tolerance});
+}
+
+} // namespace pc::operators
@@ -0,0 +1,28 @@
+#pragma once
+#include "../serialization.h"
+#include "operator.h"
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+// Background learns where each depth pixel lands while the scene is empty,
+// then removes points that are still there. Like Temporal it runs on each
+// device's cloud before the merge, while point indices are depth pixels, so
+// static geometry is dropped before any later operator has to process it.
+struct BackgroundOperatorConfiguration {
+  uid id;
+  bool enabled = true;
+  // frames averaged into each pixel's background position before any
+  // points are removed
+  int learning_frames = 60; // @minmax(1, 600)
+  // points within this distance in mm of their pixel's background position
+  // are removed
+  float tolerance = 40.0f; // @minmax(1, 500)
+  // incremented by the operator window to discard the model and learn it
+  // again from the next frame. each device's model compares it with the
+  // generation it learned, so every device relearns exactly once.
+  int relearn_generation = 0;
+};
+
+} // namespace pc::operators
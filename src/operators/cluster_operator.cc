@@ -0,0 +1,84 @@
+#include "../publisher/publisher.h"
+#include "cluster_operator.gen.h"
+#include <array>
+#include <string>
+#include <unordered_map>
+
+namespace pc::operators {
+
+struct ClusterTracks {
+  int next_id = 0;
+  std::vector<Cluster> previous;
+};
+
+// post-merge operators run on one thread, so tracks need no locking
+static std::unordered_map<uid, ClusterTracks> cluster_tracks;
+
+void ClusterOperator::track(const ClusterOperatorConfiguration &config,
+                            std::vector<Cluster> &clusters) {
+  auto &tracks = cluster_tracks[config.id];
+  const float max_distance_squared =
+      config.tracking_distance * config.tracking_distance;
+
+  // greedily match the largest clusters first, since they're the most
+  // stable from frame to frame
+  std::vector<bool> matched(tracks.previous.size(), false);
+  for (auto &cluster : clusters) {
+    int nearest = -1;
+    float nearest_distance_squared = max_distance_squared;
+    for (std::size_t i = 0; i < tracks.previous.size(); i++) {
+      if (matched[i]) continue;
+      const auto &previous = tracks.previous[i];
+      const float dx = cluster.centroid_x - previous.centroid_x;
+      const float dy = cluster.centroid_y - previous.centroid_y;
+      const float dz = cluster.centroid_z - previous.centroid_z;
+      const float distance_squared = dx * dx + dy * dy + dz * dz;
+      if (distance_squared < nearest_distance_squared) {
+        nearest = static_cast<int>(i);
+        nearest_distance_squared = distance_squared;
+      }
+    }
+    if (nearest >= 0) {
+      matched[nearest] = true;
+      cluster.id = tracks.previous[nearest].id;
+    } else {
+      cluster.id = tracks.next_id++;
+    }
+  }
+
+  tracks.previous = clusters;
+}
+
+void ClusterOperator::publish(const ClusterOperatorConfiguration &config,
+                              const std::vector<Cluster> &clusters) {
+  std::vector<int> ids;
+  std::vector<int> point_counts;
+  std::vector<std::array<float, 3>> centroids;
+  // min x, y, z followed by max x, y, z
+  std::vector<std::array<float, 6>> bounds;
+  ids.reserve(clusters.size());
+  point_counts.reserve(clusters.size());
+  centroids.reserve(clusters.size());
+  bounds.reserve(clusters.size());
+
+  // published in metres, like the rest of the operator outputs
+  for (const auto &cluster : clusters) {
+    ids.push_back(cluster.id);
+    point_counts.push_back(cluster.point_count);
+    centroids.push_back({cluster.centroid_x / 1000.0f,
+                         cluster.centroid_y / 1000.0f,
+                         cluster.centroid_z / 1000.0f});
+    bounds.push_back({cluster.min_x / 1000.0f, cluster.min_y / 1000.0f,
+                      cluster.min_z / 1000.0f, cluster.max_x / 1000.0f,
+                      cluster.max_y / 1000.0f, cluster.max_z / 1000.0f});
+  }
+
+  const auto id = std::to_string(config.id);
+  publisher::publish_all("ids", ids, {"operator", "cluster", id});
+  publisher::publish_all("point_counts", point_counts,
+                         {"operator", "cluster", id});
+  publisher::publish_all("centroids", centroids, {"operator", "cluster", id});
+  publisher::publish_all("bounds", bounds, {"operator", "cluster", id});
+}
+
+} // namespace pc::operators
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "../structs.h"
+#include "cluster_operator.gen.h"
+#include "voxel_grid.cuh"
+#include <algorithm>
+#include <cstdint>
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/for_each.h>
+#include <thrust/functional.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/remove.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/transform_reduce.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pc::operators {
+
+struct ClusterStats {
+  std::uint32_t point_count;
+  std::int64_t sum_x, sum_y, sum_z;
+  short min_x, max_x;
+  short min_y, max_y;
+  short min_z, max_z;
+};
+
+// Connected components are found by label propagation over occupied
+// voxels. Every voxel starts labelled with its own cell index, and each
+// round takes the smallest label among the voxel and its 26 neighbours.
+// Labels always name a cell in the same component, so following a label
+// to its own label (pointer jumping) is valid too, which cuts the number
+// of rounds from the diameter of a component to roughly its logarithm.
+struct hook_cluster_labels {
+  VoxelGridView grid;
+  const int *labels;
+  int *hooked_labels;
+
+  __host__ __device__ void operator()(int cell) const {
+    int x, y, z;
+    VoxelGridView::coordinates(grid.cell_keys[cell], x, y, z);
+    int label = labels[cell];
+    for (int dz = -1; dz <= 1; dz++) {
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          const int neighbour =
+              grid.find_cell(VoxelGridView::key(x + dx, y + dy, z + dz));
+          if (neighbour >= 0 && labels[neighbour] < label) {
+            label = labels[neighbour];
+          }
+        }
+      }
+    }
+    hooked_labels[cell] = label;
+  }
+};
+
+struct jump_cluster_labels {
+  const int *hooked_labels;
+  int *jumped_labels;
+
+  __host__ __device__ void operator()(int cell) const {
+    jumped_labels[cell] = hooked_labels[hooked_labels[cell]];
+  }
+};
+
+struct cluster_label_changed {
+  const int *labels;
+  const int *next_labels;
+
+  __host__ __device__ int operator()(int cell) const {
+    return labels[cell] != next_labels[cell] ? 1 : 0;
+  }
+};
+
+struct voxel_cluster_stats {
+  VoxelGridView grid;
+
+  __host__ __device__ ClusterStats operator()(int cell) const {
+    const int first = grid.cell_starts[cell];
+    const int last = grid.cell_starts[cell + 1];
+    const auto pos = grid.sorted_positions[first];
+    ClusterStats stats{0, 0, 0, 0, pos.x, pos.x, pos.y, pos.y, pos.z, pos.z};
+    for (int slot = first; slot < last; slot++) {
+      const auto p = grid.sorted_positions[slot];
+      stats.point_count++;
+      stats.sum_x += p.x;
+      stats.sum_y += p.y;
+      stats.sum_z += p.z;
+      stats.min_x = p.x < stats.min_x ? p.x : stats.min_x;
+      stats.max_x = p.x > stats.max_x ? p.x : stats.max_x;
+      stats.min_y = p.y < stats.min_y ? p.y : stats.min_y;
+      stats.max_y = p.y > stats.max_y ? p.y : stats.max_y;
+      stats.min_z = p.z < stats.min_z ? p.z : stats.min_z;
+      stats.max_z = p.z > stats.max_z ? p.z : stats.max_z;
+    }
+    return stats;
+  }
+};
+
+struct merge_cluster_stats {
+  __host__ __device__ ClusterStats operator()(const ClusterStats &lhs,
+                                              const ClusterStats &rhs) const {
+    return {lhs.point_count + rhs.point_count,
+            lhs.sum_x + rhs.sum_x,
+            lhs.sum_y + rhs.sum_y,
+            lhs.sum_z + rhs.sum_z,
+            lhs.min_x < rhs.min_x ? lhs.min_x : rhs.min_x,
+            lhs.max_x > rhs.max_x ? lhs.max_x : rhs.max_x,
+            lhs.min_y < rhs.min_y ? lhs.min_y : rhs.min_y,
+            lhs.max_y > rhs.max_y ? lhs.max_y : rhs.max_y,
+            lhs.min_z < rhs.min_z ? lhs.min_z : rhs.min_z,
+            lhs.max_z > rhs.max_z ? lhs.max_z : rhs.max_z};
+  }
+};
+
+struct cluster_too_small {
+  std::uint32_t min_points;
+  __host__ __device__ bool operator()(const ClusterStats &stats) const {
+    return stats.point_count < min_points;
+  }
+};
+
+// Finds the clusters of touching voxels among the points between begin and
+// end, largest first, without changing the points. Ids are left for
+// ClusterOperator::track to assign.
+template <typename ExecutionPolicy, typename Allocator, typename Iterator>
+std::vector<Cluster>
+run_clusters(const ExecutionPolicy &policy,
+             VoxelGridCache<Allocator> &voxel_grids, Iterator begin,
+             Iterator end, const ClusterOperatorConfiguration &config) {
+  constexpr bool on_device =
+      std::is_same_v<thrust::iterator_system_t<Iterator>,
+                     thrust::device_system_tag>;
+
+  std::vector<Cluster> clusters;
+  if (thrust::distance(begin, end) == 0) return clusters;
+
+  const auto grid =
+      voxel_grids.get(policy, begin, end, config.voxel_size).view();
+  const auto cell_count = static_cast<std::size_t>(grid.cell_count);
+  auto &allocator = voxel_grids.allocator();
+
+  ScratchBuffer<int, Allocator> label_buffer(allocator, cell_count);
+  ScratchBuffer<int, Allocator> hooked_buffer(allocator, cell_count);
+  ScratchBuffer<int, Allocator> jumped_buffer(allocator, cell_count);
+  auto labels = label_buffer.data();
+  auto hooked = hooked_buffer.data();
+  auto jumped = jumped_buffer.data();
+
+  const auto cells_begin = thrust::make_counting_iterator(0);
+  const auto cells_end = cells_begin + cell_count;
+
+  thrust::sequence(policy, labels, labels + cell_count);
+  // convergence normally takes a handful of rounds. the limit only guards
+  // against pathological shapes stalling the pipeline.
+  constexpr int max_rounds = 64;
+  for (int round = 0; round < max_rounds; round++) {
+    thrust::for_each(policy, cells_begin, cells_end,
+                     hook_cluster_labels{grid, labels, hooked});
+    thrust::for_each(policy, cells_begin, cells_end,
+                     jump_cluster_labels{hooked, jumped});
+    const int changed = thrust::transform_reduce(
+        policy, cells_begin, cells_end, cluster_label_changed{labels, jumped},
+        0, thrust::plus<int>{});
+    std::swap(labels, jumped);
+    if (changed == 0) break;
+  }
+
+  // gather voxel statistics by label, then reduce them into clusters
+  ScratchBuffer<ClusterStats, Allocator> voxel_stats(allocator, cell_count);
+  ScratchBuffer<ClusterStats, Allocator> cluster_stats(allocator, cell_count);
+  thrust::transform(policy, cells_begin, cells_end, voxel_stats.data(),
+                    voxel_cluster_stats{grid});
+  thrust::sort_by_key(policy, labels, labels + cell_count,
+                      voxel_stats.data());
+  const auto reduced_end = thrust::reduce_by_key(
+      policy, labels, labels + cell_count, voxel_stats.data(),
+      thrust::make_discard_iterator(), cluster_stats.data(),
+      thrust::equal_to<int>{}, merge_cluster_stats{});
+  auto stats_end = thrust::remove_if(
+      policy, cluster_stats.data(), reduced_end.second,
+      cluster_too_small{static_cast<std::uint32_t>(config.min_points)});
+  const std::size_t cluster_count = stats_end - cluster_stats.data();
+
+  // the surviving clusters are few enough to finish on the host
+  std::vector<ClusterStats> host_stats(cluster_count);
+  if constexpr (on_device) {
+    const auto stats_begin = thrust::device_pointer_cast(cluster_stats.data());
+    thrust::copy(stats_begin, stats_begin + cluster_count, host_stats.begin());
+  } else {
+    std::copy(cluster_stats.data(), stats_end, host_stats.begin());
+  }
+
+  std::sort(host_stats.begin(), host_stats.end(),
+            [](const auto &lhs, const auto &rhs) {
+              return lhs.point_count > rhs.point_count;
+            });
+  const auto max_clusters = static_cast<std::size_t>(
+      std::clamp(config.max_clusters, 1, ClusterOperator::max_cluster_count));
+  if (host_stats.size() > max_clusters) host_stats.resize(max_clusters);
+
+  clusters.reserve(host_stats.size());
+  for (const auto &stats : host_stats) {
+    const float count = static_cast<float>(stats.point_count);
+    clusters.push_back({-1, static_cast<int>(stats.point_count),
+                        stats.sum_x / count, stats.sum_y / count,
+                        stats.sum_z / count, stats.min_x, stats.max_x,
+                        stats.min_y, stats.max_y, stats.min_z, stats.max_z});
+  }
+  return clusters;
+}
+
+} // namespace pc::operators
@@ -0,0 +1,53 @@
+#pragma once
+#include "../serialization.h"
+#include "operator.h"
+#include <vector>
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+struct ClusterOperatorConfiguration {
+  uid id;
+  bool enabled = true;
+  // points in touching voxels of this size in mm belong to the same cluster
+  float voxel_size = 50.0f; // @minmax(5, 500)
+  // clusters with fewer points are ignored
+  int min_points = 200; // @minmax(1, 10000)
+  // only the largest clusters are tracked and published
+  int max_clusters = 16; // @minmax(1, 64)
+  // a cluster keeps its id if its centroid has moved less than this in mm
+  // since the last frame
+  float tracking_distance = 300.0f; // @minmax(10, 2000)
+  bool publish = true;
+};
+
+// people seen by more than one device should be one cluster
+template <>
+inline constexpr OperatorStage
+    operator_stage<ClusterOperatorConfiguration> = OperatorStage::PostMerge;
+
+struct Cluster {
+  // stays the same while the cluster is tracked from frame to frame
+  int id;
+  int point_count;
+  float centroid_x, centroid_y, centroid_z;
+  short min_x, max_x;
+  short min_y, max_y;
+  short min_z, max_z;
+};
+
+struct ClusterOperator {
+
+  static constexpr int max_cluster_count = 64;
+
+  // gives each cluster the id of the nearest cluster from the operator's
+  // previous frame, or a new id if none was close enough
+  static void track(const ClusterOperatorConfiguration &config,
+                    std::vector<Cluster> &clusters);
+
+  static void publish(const ClusterOperatorConfiguration &config,
+                      const std::vector<Cluster> &clusters);
+};
+
+} // namespace pc::operators
@@ -1,12 +1,172 @@
 #include "../../structs.h"
+#include "../voxel_grid.cuh"
 #include "denoise_operator.gen.h"
+#include <algorithm>
+#include <cmath>
 #include <thrust/functional.h>
+#include <thrust/remove.h>
+#include <thrust/scatter.h>
+#include <thrust/transform_reduce.h>
 
 namespace pc::operators {
 
-__device__ bool DenoiseOperator::operator()(indexed_point_t point) const {
+__host__ __device__ bool DenoiseOperator::operator()(indexed_point_t point) const {
   auto &pos = thrust::get<0>(point);
   return true;
 };
 
+// Both denoise modes measure each point's neighbourhood on the voxel grid,
+// built with a voxel size equal to the search radius, so that every
+// neighbour within the radius is somewhere in the surrounding 3x3x3 voxels.
+
+// statistical mode: mean distance to the nearest neighbour_count points
+// within the radius. missing neighbours count as being at the radius.
+struct mean_neighbour_distance {
+  VoxelGridView grid;
+  float radius;
+  int neighbour_count;
+
+  __host__ __device__ float operator()(int slot) const {
+    const auto pos = grid.sorted_positions[slot];
+    const float radius_squared = radius * radius;
+
+    // the smallest squared distances seen so far, kept sorted
+    float nearest[DenoiseOperator::max_neighbour_count];
+    int found = 0;
+
+    grid.for_each_neighbour_slot(pos, [&](int other_slot) {
+      if (other_slot == slot) return;
+      const auto other = grid.sorted_positions[other_slot];
+      const float dx = other.x - pos.x;
+      const float dy = other.y - pos.y;
+      const float dz = other.z - pos.z;
+      const float distance_squared = dx * dx + dy * dy + dz * dz;
+      if (distance_squared > radius_squared) return;
+      if (found == neighbour_count &&
+          distance_squared >= nearest[found - 1])
+        return;
+      int i = found < neighbour_count ? found++ : found - 1;
+      while (i > 0 && nearest[i - 1] > distance_squared) {
+        nearest[i] = nearest[i - 1];
+        i--;
+      }
+      nearest[i] = distance_squared;
+    });
+
+    float total = (neighbour_count - found) * radius;
+    for (int i = 0; i < found; i++) total += sqrtf(nearest[i]);
+    return total / neighbour_count;
+  }
+};
+
+// radius mode: how many other points are within the radius
+struct radius_neighbour_count {
+  VoxelGridView grid;
+  float radius;
+
+  __host__ __device__ float operator()(int slot) const {
+    const auto pos = grid.sorted_positions[slot];
+    const float radius_squared = radius * radius;
+    int count = 0;
+    grid.for_each_neighbour_slot(pos, [&](int other_slot) {
+      const auto other = grid.sorted_positions[other_slot];
+      const float dx = other.x - pos.x;
+      const float dy = other.y - pos.y;
+      const float dz = other.z - pos.z;
+      if (dx * dx + dy * dy + dz * dz <= radius_squared) count++;
+    });
+    // the point itself was counted
+    return static_cast<float>(count - 1);
+  }
+};
+
+struct DenoiseMoments {
+  double sum;
+  double sum_squared;
+};
+
+struct denoise_moments_of {
+  __host__ __device__ DenoiseMoments operator()(float value) const {
+    return {value, static_cast<double>(value) * value};
+  }
+};
+
+struct add_denoise_moments {
+  __host__ __device__ DenoiseMoments operator()(const DenoiseMoments &lhs,
+                                                const DenoiseMoments &rhs) const {
+    return {lhs.sum + rhs.sum, lhs.sum_squared + rhs.sum_squared};
+  }
+};
+
+struct denoise_metric_above {
+  float threshold;
+  __host__ __device__ bool operator()(float metric) const {
+    return metric > threshold;
+  }
+};
+
+struct denoise_metric_below {
+  float threshold;
+  __host__ __device__ bool operator()(float metric) const {
+    return metric < threshold;
+  }
+};
+
+// Removes outliers from the points between begin and end in the execution
+// space of the policy, returning the new end.
+template <typename ExecutionPolicy, typename Allocator, typename Iterator>
+Iterator run_denoise(const ExecutionPolicy &policy,
+                     VoxelGridCache<Allocator> &voxel_grids, Iterator begin,
+                     Iterator end, const DenoiseOperatorConfiguration &config) {
+  // a bypassed denoise has nothing to report, so it costs nothing
+  if (config.bypass) return end;
+
+  const std::size_t point_count = thrust::distance(begin, end);
+  if (point_count == 0) return end;
+
+  auto &allocator = voxel_grids.allocator();
+  const auto grid_view =
+      voxel_grids.get(policy, begin, end, config.radius).view();
+
+  // measure each point in sorted order, where neighbours are adjacent in
+  // memory, then scatter the results back to the points' own order
+  ScratchBuffer<float, Allocator> sorted_metrics(allocator, point_count);
+  ScratchBuffer<float, Allocator> metrics(allocator, point_count);
+  const auto slots_begin = thrust::make_counting_iterator(0);
+  const auto slots_end = slots_begin + point_count;
+
+  const auto mode = static_cast<DenoiseMode>(config.mode);
+  if (mode == DenoiseMode::Radius) {
+    thrust::transform(policy, slots_begin, slots_end, sorted_metrics.data(),
+                      radius_neighbour_count{grid_view, config.radius});
+  } else {
+    const auto neighbour_count = std::clamp(
+        config.neighbour_count, 1, DenoiseOperator::max_neighbour_count);
+    thrust::transform(policy, slots_begin, slots_end, sorted_metrics.data(),
+                      mean_neighbour_distance{grid_view, config.radius,
+                                              neighbour_count});
+  }
+  thrust::scatter(policy, sorted_metrics.data(),
+                  sorted_metrics.data() + point_count,
+                  grid_view.sorted_indices, metrics.data());
+
+  if (mode == DenoiseMode::Radius) {
+    return thrust::remove_if(
+        policy, begin, end, metrics.data(),
+        denoise_metric_below{static_cast<float>(config.min_neighbours)});
+  }
+
+  const auto moments = thrust::transform_reduce(
+      policy, metrics.data(), metrics.data() + point_count,
+      denoise_moments_of{}, DenoiseMoments{0, 0}, add_denoise_moments{});
+  const double mean = moments.sum / point_count;
+  const double variance =
+      std::max(0.0, moments.sum_squared / point_count - mean * mean);
+  const auto threshold = static_cast<float>(
+      mean + config.std_dev_multiplier * std::sqrt(variance));
+
+  return thrust::remove_if(policy, begin, end, metrics.data(),
+                           denoise_metric_above{threshold});
+}
+
 } // namespace pc::operators
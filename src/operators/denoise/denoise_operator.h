@@ -17,8 +17,25 @@ struct DenoiseOperatorConfiguration {
   bool enabled = true;
   bool bypass = false;
   bool draw = true;
+  int mode = 0; // 0: statistical outliers, 1: radius outliers @optional
+  // neighbours are only searched for within this distance, in mm
+  float radius = 30.0f; // @minmax(1, 500) @optional
+  // statistical mode: points whose mean distance to their nearest
+  // neighbour_count neighbours is more than std_dev_multiplier standard
+  // deviations above the cloud's mean are removed
+  int neighbour_count = 8; // @minmax(1, 32) @optional
+  float std_dev_multiplier = 1.0f; // @minmax(0, 5) @optional
+  // radius mode: points with fewer neighbours than this are removed
+  int min_neighbours = 4; // @minmax(1, 64) @optional
 };
 
+enum class DenoiseMode { Statistical = 0, Radius = 1 };
+
+// neighbouring points can come from overlapping devices
+template <>
+inline constexpr OperatorStage
+    operator_stage<DenoiseOperatorConfiguration> = OperatorStage::PostMerge;
+
 struct DenoiseOperator : Operator {
 
   DenoiseOperatorConfiguration _config;
@@ -26,7 +43,9 @@ struct DenoiseOperator : Operator {
   DenoiseOperator(const DenoiseOperatorConfiguration &config)
       : _config(config){};
 
-  __device__ bool operator()(indexed_point_t point) const;
+  __host__ __device__ bool operator()(indexed_point_t point) const;
+
+  static constexpr int max_neighbour_count = 32;
 };
 
 } // namespace pc::operators
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+// Forward declarations hide CUDA types from TUs not compiled with nvcc
+struct TemporalHistory;
+struct BackgroundModel;
+
+// The per-pixel state that operators keep between the frames of one
+// device, keyed by operator id. Each entry is allocated the first time its
+// operator runs and reused for every frame after that.
+class FrameHistories {
+public:
+  FrameHistories() = default;
+  ~FrameHistories();
+
+  FrameHistories(const FrameHistories &) = delete;
+  FrameHistories &operator=(const FrameHistories &) = delete;
+
+  // the number of depth pixels in each frame from the device. zero when the
+  // points don't come from an organized frame, and then operators that need
+  // pixel history are skipped.
+  std::size_t pixel_count = 0;
+
+  TemporalHistory &temporal(uid operator_id);
+  BackgroundModel &background(uid operator_id);
+
+private:
+  std::unordered_map<uid, TemporalHistory *> _temporal;
+  std::unordered_map<uid, BackgroundModel *> _background;
+};
+
+} // namespace pc::operators
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "noise_operator.cuh"
+#include "rake_operator.cuh"
+#include "rotate_operator.cuh"
+#include "sample_filter_operator.cuh"
+#include <cstdint>
+#include <new>
+#include <thrust/remove.h>
+#include <thrust/transform.h>
+#include <type_traits>
+
+namespace pc::operators {
+
+// Runs of adjacent operators that only look at one point at a time are
+// collected into a FusedOperator and executed as a single transform pass
+// over the cloud (plus one compaction if the run contains filters), instead
+// of one full read and write of every point per operator.
+//
+// Transforms are applied in the order they were added. Fused filters only
+// depend on the point's index, which transforms never change, so they are
+// combined into one predicate and can be evaluated before any transform.
+class FusedOperator {
+public:
+  static constexpr std::size_t capacity = 8;
+
+  template <typename T>
+  static constexpr bool is_transform =
+      std::is_same_v<T, NoiseOperatorConfiguration> ||
+      std::is_same_v<T, RotateOperatorConfiguration> ||
+      std::is_same_v<T, RakeOperatorConfiguration>;
+
+  template <typename T>
+  static constexpr bool is_filter =
+      std::is_same_v<T, SampleFilterOperatorConfiguration>;
+
+  template <typename T>
+  static constexpr bool can_fuse = is_transform<T> || is_filter<T>;
+
+  bool empty() const { return _step_count == 0; }
+  bool full() const { return _step_count == capacity; }
+  int step_count() const { return _step_count; }
+  bool has_filters() const { return _filter_count > 0; }
+
+  void clear() {
+    _step_count = 0;
+    _filter_count = 0;
+  }
+
+  // returns false if the operator doesn't fit and the run needs to be
+  // flushed first
+  template <typename T> bool push(const T &config) {
+    static_assert(can_fuse<T>, "Operator can't be fused");
+    if (full()) return false;
+    auto &step = _steps[_step_count++];
+    if constexpr (std::is_same_v<T, NoiseOperatorConfiguration>) {
+      step.kind = StepKind::Noise;
+      new (&step.noise) NoiseOperator(config);
+    } else if constexpr (std::is_same_v<T, RotateOperatorConfiguration>) {
+      step.kind = StepKind::Rotate;
+      new (&step.rotate) RotateOperator(config);
+    } else if constexpr (std::is_same_v<T, RakeOperatorConfiguration>) {
+      step.kind = StepKind::Rake;
+      new (&step.rake) RakeOperator(config);
+    } else if constexpr (std::is_same_v<T,
+                                        SampleFilterOperatorConfiguration>) {
+      step.kind = StepKind::SampleFilter;
+      new (&step.sample_filter) SampleFilterOperator(config);
+      _filter_count++;
+    }
+    return true;
+  }
+
+  __host__ __device__ indexed_point_t transform(indexed_point_t point) const {
+    for (int i = 0; i < _step_count; i++) {
+      const auto &step = _steps[i];
+      switch (step.kind) {
+      case StepKind::Noise: point = step.noise(point); break;
+      case StepKind::Rotate: point = step.rotate(point); break;
+      case StepKind::Rake: point = step.rake(point); break;
+      default: break;
+      }
+    }
+    return point;
+  }
+
+  __host__ __device__ bool keep(indexed_point_t point) const {
+    for (int i = 0; i < _step_count; i++) {
+      const auto &step = _steps[i];
+      if (step.kind == StepKind::SampleFilter && !step.sample_filter(point))
+        return false;
+    }
+    return true;
+  }
+
+private:
+  enum class StepKind : std::uint8_t { Noise, Rotate, Rake, SampleFilter };
+
+  // the operator functors are trivially copyable, so a step can be copied
+  // to the device as plain bytes along with the rest of the run
+  struct Step {
+    StepKind kind;
+    union {
+      NoiseOperator noise;
+      RotateOperator rotate;
+      RakeOperator rake;
+      SampleFilterOperator sample_filter;
+    };
+    Step() {}
+  };
+
+  Step _steps[capacity];
+  int _step_count = 0;
+  int _filter_count = 0;
+};
+
+struct fused_transform
+    : public thrust::unary_function<indexed_point_t, indexed_point_t> {
+  FusedOperator fused;
+  __host__ __device__ indexed_point_t operator()(indexed_point_t point) const {
+    return fused.transform(point);
+  }
+};
+
+struct fused_filter_rejects {
+  FusedOperator fused;
+  __host__ __device__ bool operator()(indexed_point_t point) const {
+    return !fused.keep(point);
+  }
+};
+
+// Runs every operator in the run over the points between begin and end in
+// the execution space of the policy, returning the new end.
+template <typename ExecutionPolicy, typename Iterator>
+Iterator run_fused(const ExecutionPolicy &policy, Iterator begin,
+                   Iterator end, const FusedOperator &fused) {
+  // filtering first means the transforms only touch surviving points
+  if (fused.has_filters()) {
+    end = thrust::remove_if(policy, begin, end,
+                            fused_filter_rejects{fused});
+  }
+  thrust::transform(policy, begin, end, begin, fused_transform{fused});
+  return end;
+}
+
+} // namespace pc::operators
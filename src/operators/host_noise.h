@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Host implementation of the fractal simplex noise used by NoiseOperator, so
+// it can run on the CPU backend where cudaNoise's device-only functions
+// aren't available. The shape of the noise matches (3D simplex noise summed
+// over octaves) but the values are not bit-identical with the GPU version.
+
+namespace pc::operators::host_noise {
+
+inline std::uint32_t hash(std::int32_t x, std::int32_t y, std::int32_t z,
+                          std::int32_t seed) {
+  std::uint32_t h = static_cast<std::uint32_t>(seed) * 0x27d4eb2dU;
+  h ^= static_cast<std::uint32_t>(x) * 0x8da6b343U;
+  h ^= static_cast<std::uint32_t>(y) * 0xd8163841U;
+  h ^= static_cast<std::uint32_t>(z) * 0xcb1ab31fU;
+  h ^= h >> 15;
+  h *= 0x2c1b3c6dU;
+  h ^= h >> 12;
+  return h;
+}
+
+inline float gradient_dot(std::uint32_t hash, float x, float y, float z) {
+  // the twelve edge directions of a cube
+  switch (hash % 12) {
+  case 0: return x + y;
+  case 1: return -x + y;
+  case 2: return x - y;
+  case 3: return -x - y;
+  case 4: return x + z;
+  case 5: return -x + z;
+  case 6: return x - z;
+  case 7: return -x - z;
+  case 8: return y + z;
+  case 9: return -y + z;
+  case 10: return y - z;
+  default: return -y - z;
+  }
+}
+
+// 3D simplex noise in the range [-1, 1]
+inline float simplex(float x, float y, float z, int seed) {
+  constexpr float skew = 1.0f / 3.0f;
+  constexpr float unskew = 1.0f / 6.0f;
+
+  const float s = (x + y + z) * skew;
+  const auto i = static_cast<std::int32_t>(std::floor(x + s));
+  const auto j = static_cast<std::int32_t>(std::floor(y + s));
+  const auto k = static_cast<std::int32_t>(std::floor(z + s));
+
+  const float t = (i + j + k) * unskew;
+  const float x0 = x - (i - t);
+  const float y0 = y - (j - t);
+  const float z0 = z - (k - t);
+
+  // find which of the six tetrahedra of the skewed cube we're in
+  int i1, j1, k1, i2, j2, k2;
+  if (x0 >= y0) {
+    if (y0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+    else { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+  } else {
+    if (y0 < z0) { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+    else if (x0 < z0) { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+    else { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+  }
+
+  const float offsets[4][3] = {
+      {x0, y0, z0},
+      {x0 - i1 + unskew, y0 - j1 + unskew, z0 - k1 + unskew},
+      {x0 - i2 + 2 * unskew, y0 - j2 + 2 * unskew, z0 - k2 + 2 * unskew},
+      {x0 - 1 + 3 * unskew, y0 - 1 + 3 * unskew, z0 - 1 + 3 * unskew}};
+  const std::int32_t corners[4][3] = {
+      {i, j, k}, {i + i1, j + j1, k + k1}, {i + i2, j + j2, k + k2},
+      {i + 1, j + 1, k + 1}};
+
+  float result = 0;
+  for (int c = 0; c < 4; c++) {
+    const auto [dx, dy, dz] = offsets[c];
+    float falloff = 0.6f - dx * dx - dy * dy - dz * dz;
+    if (falloff <= 0) continue;
+    falloff *= falloff;
+    const auto h = hash(corners[c][0], corners[c][1], corners[c][2], seed);
+    result += falloff * falloff * gradient_dot(h, dx, dy, dz);
+  }
+  return 32.0f * result;
+}
+
+// sums octaves of simplex noise, each scaled by lacunarity in frequency and
+// decay in amplitude, with the same parameters as cudaNoise::repeaterSimplex
+inline float repeater_simplex(float x, float y, float z, float scale, int seed,
+                              int repeat, float lacunarity, float decay) {
+  float result = 0;
+  float amplitude = 1;
+  for (int octave = 0; octave < repeat; octave++) {
+    result += simplex(x * scale, y * scale, z * scale, seed + octave) *
+              amplitude * 0.35f;
+    scale *= lacunarity;
+    amplitude *= decay;
+  }
+  return result;
+}
+
+} // namespace pc::operators::host_noise
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../structs.h"
+#include "host_noise.h"
 #include "noise_operator.gen.h"
 #include <cuda_noise.cuh>
 #include <thrust/functional.h>
@@ -16,7 +17,7 @@ struct NoiseOperator : Operator {
 
   NoiseOperator(const NoiseOperatorConfiguration &config) : _config(config){};
 
-  __device__ indexed_point_t operator()(indexed_point_t point) const {
+  __host__ __device__ indexed_point_t operator()(indexed_point_t point) const {
     position pos = thrust::get<0>(point);
     color col = thrust::get<1>(point);
     int index = thrust::get<2>(point);
@@ -31,6 +32,7 @@ struct NoiseOperator : Operator {
     auto &lacunarity = _config.lacunarity;
     auto &decay = _config.decay;
 
+#ifdef __CUDA_ARCH__
     pos.x += cudaNoise::repeaterSimplex({pos_f.x, pos_f.y, pos_f.z}, scale,
                                         seed, repeat, lacunarity, decay) *
              magnitude;
@@ -40,6 +42,18 @@ struct NoiseOperator : Operator {
     pos.z += cudaNoise::repeaterSimplex({pos_f.y, pos_f.z, pos_f.x}, scale,
                                         seed, repeat, lacunarity, decay) *
              magnitude;
+#else
+    using host_noise::repeater_simplex;
+    pos.x += repeater_simplex(pos_f.x, pos_f.y, pos_f.z, scale, seed, repeat,
+                              lacunarity, decay) *
+             magnitude;
+    pos.y += repeater_simplex(pos_f.z, pos_f.x, pos_f.y, scale, seed, repeat,
+                              lacunarity, decay) *
+             magnitude;
+    pos.z += repeater_simplex(pos_f.y, pos_f.z, pos_f.x, scale, seed, repeat,
+                              lacunarity, decay) *
+             magnitude;
+#endif
 
     return thrust::make_tuple(pos, col, index);
   }
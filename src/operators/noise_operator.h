@@ -24,7 +24,7 @@ struct NoiseOperator : public Operator {
 
   NoiseOperator(const NoiseOperatorConfiguration &config);
   
-  __device__ indexed_point_t operator()(indexed_point_t point) const;
+  __host__ __device__ indexed_point_t operator()(indexed_point_t point) const;
 };
 
 } // namespace pc::operators
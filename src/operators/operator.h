@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../structs.h"
+#include <cmath>
 #include <thrust/device_vector.h>
 #include <thrust/iterator/zip_iterator.h>
 #include <thrust/tuple.h>
@@ -11,14 +12,38 @@ typedef thrust::tuple<pc::types::position, pc::types::color> point_t;
 typedef thrust::tuple<pc::types::position, pc::types::color, int>
     indexed_point_t;
 
-typedef thrust::zip_iterator<
-    thrust::tuple<thrust::device_vector<pc::types::position>::iterator,
-                  thrust::device_vector<pc::types::color>::iterator,
-                  thrust::device_vector<int>::iterator>>
+// Operators run over zipped position, color and index sequences. The
+// iterator types decide which Thrust system executes them.
+template <typename PositionIterator, typename ColorIterator,
+          typename IndexIterator>
+using operator_iterator_t = thrust::zip_iterator<
+    thrust::tuple<PositionIterator, ColorIterator, IndexIterator>>;
+
+// points in GPU memory, processed by the CUDA system
+typedef operator_iterator_t<thrust::device_vector<pc::types::position>::iterator,
+                            thrust::device_vector<pc::types::color>::iterator,
+                            thrust::device_vector<int>::iterator>
     operator_in_out_t;
 
+// points in host memory, processed by the multicore CPU system
+typedef operator_iterator_t<pc::types::position *, pc::types::color *, int *>
+    operator_host_in_out_t;
+
 using Operator = thrust::unary_function<indexed_point_t, indexed_point_t>;
 
+// Where an operator runs: on each device's cloud as it's ingested, or once
+// on the merged cloud of every device. Each operator declares its stage by
+// specialising operator_stage for its configuration type.
+//
+// Stages run one after the other, each keeping list order within itself,
+// so every per-device operator runs before every post-merge operator no
+// matter where they sit in the session's list. The operator window labels
+// operators whose position in the list doesn't match when they run.
+enum class OperatorStage { PerDevice, PostMerge };
+
+template <typename Configuration>
+inline constexpr OperatorStage operator_stage = OperatorStage::PerDevice;
+
 struct get_position {
   __host__ __device__ pc::types::position
   operator()(indexed_point_t point) const {
@@ -26,4 +51,14 @@ struct get_position {
   }
 };
 
+// float to short conversion rounding towards negative infinity, matching on
+// both host and device
+__host__ __device__ inline short float_to_short_rd(float value) {
+#ifdef __CUDA_ARCH__
+  return (short)__float2int_rd(value);
+#else
+  return (short)std::floor(value);
+#endif
+}
+
 } // namespace pc::operators
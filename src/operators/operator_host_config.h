@@ -9,6 +9,10 @@
 #include "sample_filter_operator.gen.h"
 #include "range_filter_operator.gen.h"
 #include "denoise/denoise_operator.gen.h"
+#include "voxel_downsample_operator.gen.h"
+#include "temporal_operator.gen.h"
+#include "background_operator.gen.h"
+#include "cluster_operator.gen.h"
 #include <functional>
 #include <variant>
 
@@ -17,7 +21,11 @@ namespace pc::operators {
 using OperatorConfigurationVariant =
     std::variant<NoiseOperatorConfiguration, SampleFilterOperatorConfiguration,
 		 RangeFilterOperatorConfiguration, RotateOperatorConfiguration,
-		 RakeOperatorConfiguration, DenoiseOperatorConfiguration>;
+		 RakeOperatorConfiguration, DenoiseOperatorConfiguration,
+		 VoxelDownsampleOperatorConfiguration,
+		 TemporalOperatorConfiguration,
+		 BackgroundOperatorConfiguration,
+		 ClusterOperatorConfiguration>;
 
 // Extract types from variant into a tuple
 template <typename Variant> struct VariantTypes;
@@ -44,6 +52,8 @@ template <typename Func> constexpr void apply_to_all_operators(Func func) {
 
 struct OperatorHostConfiguration {
   bool enabled = true;
+  bool fuse_operators = true; // @optional
+  bool publish_timings = false; // @optional
   std::vector<OperatorConfigurationVariant> operators;
 };
 
@@ -0,0 +1,127 @@
+#include "operator_timing.h"
+#include "../publisher/publisher.h"
+#include "../utils/dropping_queue.h"
+#include <array>
+
+namespace pc::operators {
+
+void OperatorTimings::record(uid operator_id, std::string_view source,
+                             const OperatorTiming &timing) {
+  std::lock_guard lock(_mutex);
+  auto &sources = _timings[operator_id];
+  auto existing = sources.find(source);
+  if (existing != sources.end()) existing->second = timing;
+  else sources.emplace(std::string(source), timing);
+}
+
+std::vector<std::pair<std::string, OperatorTiming>>
+OperatorTimings::get(uid operator_id) const {
+  std::lock_guard lock(_mutex);
+  auto sources = _timings.find(operator_id);
+  if (sources == _timings.end()) return {};
+  return {sources->second.begin(), sources->second.end()};
+}
+
+OperatorTimings &operator_timings() {
+  static OperatorTimings timings;
+  return timings;
+}
+
+namespace {
+
+struct QueuedTiming {
+  uid operator_id;
+  std::string source;
+  OperatorTiming timing;
+};
+
+// if nothing is publishing, the oldest timings are dropped rather than
+// queueing without bound
+pc::utils::DroppingQueue<QueuedTiming> &queued_timings() {
+  static pc::utils::DroppingQueue<QueuedTiming> queue(1024);
+  return queue;
+}
+
+} // namespace
+
+void publish_queued_timings() {
+  QueuedTiming queued;
+  while (queued_timings().pop(queued, std::chrono::microseconds(0))) {
+    const auto &timing = queued.timing;
+    publisher::publish_all(
+        "timing",
+        std::array<float, 3>{timing.milliseconds,
+                             static_cast<float>(timing.points_in),
+                             static_cast<float>(timing.points_out)},
+        {"operator", std::to_string(queued.operator_id), queued.source});
+  }
+}
+
+OperatorTimer::~OperatorTimer() {
+  for (auto &measurement : _measurements) {
+    if (measurement.start_event != nullptr) {
+      cudaEventDestroy(measurement.start_event);
+      cudaEventDestroy(measurement.stop_event);
+    }
+  }
+}
+
+void OperatorTimer::start(bool on_device, std::size_t points_in,
+                          cudaStream_t stream) {
+  if (_measurement_count == _measurements.size()) _measurements.emplace_back();
+  auto &measurement = _measurements[_measurement_count];
+  measurement.on_device = on_device;
+  measurement.points_in = points_in;
+  if (on_device) {
+    if (measurement.start_event == nullptr) {
+      cudaEventCreate(&measurement.start_event);
+      cudaEventCreate(&measurement.stop_event);
+    }
+    measurement.stream = stream;
+    cudaEventRecord(measurement.start_event, stream);
+  } else {
+    measurement.start_time = std::chrono::steady_clock::now();
+  }
+}
+
+void OperatorTimer::stop(std::size_t points_out,
+                         std::span<const uid> operator_ids) {
+  auto &measurement = _measurements[_measurement_count++];
+  if (measurement.on_device) {
+    cudaEventRecord(measurement.stop_event, measurement.stream);
+  } else {
+    measurement.stop_time = std::chrono::steady_clock::now();
+  }
+  measurement.points_out = points_out;
+  measurement.operator_ids.assign(operator_ids.begin(), operator_ids.end());
+}
+
+void OperatorTimer::flush(std::string_view source, bool publish) {
+  for (std::size_t i = 0; i < _measurement_count; i++) {
+    auto &measurement = _measurements[i];
+
+    OperatorTiming timing{};
+    if (measurement.on_device) {
+      cudaEventSynchronize(measurement.stop_event);
+      cudaEventElapsedTime(&timing.milliseconds, measurement.start_event,
+                           measurement.stop_event);
+    } else {
+      timing.milliseconds = std::chrono::duration<float, std::milli>(
+                                measurement.stop_time - measurement.start_time)
+                                .count();
+    }
+    timing.points_in = measurement.points_in;
+    timing.points_out = measurement.points_out;
+    timing.operator_count = static_cast<int>(measurement.operator_ids.size());
+
+    for (auto operator_id : measurement.operator_ids) {
+      operator_timings().record(operator_id, source, timing);
+      if (publish) {
+        queued_timings().push({operator_id, std::string(source), timing});
+      }
+    }
+  }
+  _measurement_count = 0;
+}
+
+} // namespace pc::operators
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cuda_runtime_api.h>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+struct OperatorTiming {
+  float milliseconds = 0;
+  std::size_t points_in = 0;
+  std::size_t points_out = 0;
+  // how many operators ran together in the measured pass. operators that
+  // were fused share one measurement.
+  int operator_count = 1;
+};
+
+// The latest timing of every operator for every source of points it runs
+// on (each device, plus "merged" for the post-merge stage). Processing
+// threads record into it while the gui reads from it.
+class OperatorTimings {
+public:
+  void record(uid operator_id, std::string_view source,
+              const OperatorTiming &timing);
+
+  std::vector<std::pair<std::string, OperatorTiming>>
+  get(uid operator_id) const;
+
+private:
+  mutable std::mutex _mutex;
+  std::map<uid, std::map<std::string, OperatorTiming, std::less<>>> _timings;
+};
+
+OperatorTimings &operator_timings();
+
+// Timings are published from one thread rather than from each processing
+// thread as it flushes, since publishers aren't safe to call concurrently.
+// OperatorTimer::flush queues them, and the frame bus calls this after each
+// synthesis to publish whatever has been queued.
+void publish_queued_timings();
+
+// Measures each pass of an operator chain run with one OperatorScratch. On
+// the CUDA backend a pass is timed by a pair of events recorded on the
+// stream the operators are issued on, so it covers the kernels themselves
+// rather than the time taken to launch them. On the host it's wall time.
+//
+// Not thread-safe: each timer belongs to one processing thread.
+class OperatorTimer {
+public:
+  OperatorTimer() = default;
+  ~OperatorTimer();
+
+  OperatorTimer(const OperatorTimer &) = delete;
+  OperatorTimer &operator=(const OperatorTimer &) = delete;
+
+  // device passes are timed on the stream their operators are issued on
+  void start(bool on_device, std::size_t points_in, cudaStream_t stream);
+  void stop(std::size_t points_out, std::span<const uid> operator_ids);
+
+  // waits for any device passes to finish and records every pass since the
+  // last flush in operator_timings(), optionally queueing them to be
+  // published by publish_queued_timings()
+  void flush(std::string_view source, bool publish);
+
+private:
+  struct Measurement {
+    bool on_device;
+    cudaStream_t stream = nullptr;
+    cudaEvent_t start_event = nullptr;
+    cudaEvent_t stop_event = nullptr;
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::steady_clock::time_point stop_time;
+    std::size_t points_in;
+    std::size_t points_out;
+    std::vector<uid> operator_ids;
+  };
+
+  // measurements and their events are reused from frame to frame
+  std::vector<Measurement> _measurements;
+  std::size_t _measurement_count = 0;
+};
+
+} // namespace pc::operators
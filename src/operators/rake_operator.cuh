@@ -8,7 +8,7 @@ namespace pc::operators {
 using pc::types::color;
 using pc::types::position;
 
-__device__ indexed_point_t RakeOperator::operator()(indexed_point_t point) const {
+__host__ __device__ indexed_point_t RakeOperator::operator()(indexed_point_t point) const {
 
   position pos = thrust::get<0>(point);
   color col = thrust::get<1>(point);
@@ -25,9 +25,9 @@ __device__ indexed_point_t RakeOperator::operator()(indexed_point_t point) const
   // Add the mapped height to the y position to create a "raked" floor
   pos_f.y += mapped_height;
 
-  position pos_out = { (short)__float2int_rd(pos_f.x),
-					  (short)__float2int_rd(pos_f.y),
-					  (short)__float2int_rd(pos_f.z), 0 };
+  position pos_out = { float_to_short_rd(pos_f.x),
+					  float_to_short_rd(pos_f.y),
+					  float_to_short_rd(pos_f.z), 0 };
 
   return thrust::make_tuple(pos_out, col, thrust::get<2>(point));
 };
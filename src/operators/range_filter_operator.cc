@@ -1,4 +1,5 @@
 #include "../gui/widgets.h"
+#include "../math.h"
 #include "../parameters.h"
 #include "range_filter_operator.gen.h"
 #include "session_bounding_boxes.h"
@@ -29,4 +30,46 @@ void RangeFilterOperator::init(const RangeFilterOperatorConfiguration &config,
 				   next_bounding_box_color());
       });
 }
+
+void RangeFilterOperator::update_statistics(
+    RangeFilterOperatorConfiguration &config,
+    const RangeFilterZoneStats &stats) {
+
+  auto &fill = config.fill;
+  auto &minmax = config.minmax;
+
+  fill.fill_count = stats.fill_count;
+
+  if (fill.fill_count <= fill.count_threshold) {
+    fill.fill_value = 0;
+    fill.proportion = 0;
+    minmax.min_x = 0;
+    minmax.max_x = 0;
+    minmax.min_y = 0;
+    minmax.max_y = 0;
+    minmax.min_z = 0;
+    minmax.max_z = 0;
+    return;
+  }
+
+  fill.fill_value = fill.fill_count / static_cast<float>(fill.max_fill);
+  fill.proportion =
+      fill.fill_count / static_cast<float>(stats.reached_count);
+
+  // minmax values are normalised within the box, which is in metres
+  const auto normalise = [](float center, float size, short value) {
+    return pc::math::remap(center - size, center + size, 0.0f, 1.0f,
+                           value / 1000.0f, true);
+  };
+
+  const auto &position = config.position;
+  const auto &size = config.size;
+  minmax.min_x = normalise(position.x, size.x, stats.min_x);
+  minmax.max_x = normalise(position.x, size.x, stats.max_x);
+  minmax.min_y = normalise(position.y, size.y, stats.min_y);
+  minmax.max_y = normalise(position.y, size.y, stats.max_y);
+  minmax.min_z = normalise(position.z, size.z, stats.min_z);
+  minmax.max_z = normalise(position.z, size.z, stats.max_z);
+}
+
 } // namespace pc::operators
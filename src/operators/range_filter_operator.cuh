@@ -1,10 +1,11 @@
 #include "../structs.h"
 #include "range_filter_operator.gen.h"
+#include <thrust/extrema.h>
 #include <thrust/functional.h>
 
 namespace pc::operators {
 
-__device__ bool RangeFilterOperator::operator()(indexed_point_t point) const {
+__host__ __device__ bool RangeFilterOperator::operator()(indexed_point_t point) const {
   auto &pos = thrust::get<0>(point);
 
   const auto &center = _config.position;
@@ -22,25 +23,141 @@ __device__ bool RangeFilterOperator::operator()(indexed_point_t point) const {
   return true;
 };
 
-__device__ bool MinMaxXComparator::operator()(indexed_point_t lhs,
+__host__ __device__ bool MinMaxXComparator::operator()(indexed_point_t lhs,
                                               indexed_point_t rhs) const {
   auto &lhs_pos = thrust::get<0>(lhs);
   auto &rhs_pos = thrust::get<0>(rhs);
   return lhs_pos.x < rhs_pos.x;
 }
 
-__device__ bool MinMaxYComparator::operator()(indexed_point_t lhs,
+__host__ __device__ bool MinMaxYComparator::operator()(indexed_point_t lhs,
                                               indexed_point_t rhs) const {
   auto &lhs_pos = thrust::get<0>(lhs);
   auto &rhs_pos = thrust::get<0>(rhs);
   return lhs_pos.y < rhs_pos.y;
 }
 
-__device__ bool MinMaxZComparator::operator()(indexed_point_t lhs,
+__host__ __device__ bool MinMaxZComparator::operator()(indexed_point_t lhs,
                                               indexed_point_t rhs) const {
   auto &lhs_pos = thrust::get<0>(lhs);
   auto &rhs_pos = thrust::get<0>(rhs);
   return lhs_pos.z < rhs_pos.z;
 }
 
+// A run of adjacent range filters, classified together so that every zone's
+// statistics come out of a single reduction over the cloud instead of a
+// compaction and three minmax passes per zone. Zones keep their list order:
+// a point only reaches a zone if no earlier, non-bypassed zone removed it.
+//
+// The reduction carries every zone's statistics as its value, so the
+// capacity is kept small enough (4 zones, 80 bytes) for that value to stay
+// in registers. Longer runs of range filters are split into several passes.
+struct RangeFilterZones {
+  static constexpr int capacity = 4;
+
+  struct Box {
+    Float3 min;
+    Float3 max;
+    bool bypass;
+  };
+
+  Box boxes[capacity];
+  int count = 0;
+  bool filters_points = false;
+
+  bool full() const { return count == capacity; }
+
+  void add(const RangeFilterOperatorConfiguration &config) {
+    const auto &center = config.position;
+    const auto &size = config.size;
+    // config is in metres, point cloud is in mm
+    boxes[count++] = {{(center.x - size.x) * 1000, (center.y - size.y) * 1000,
+                       (center.z - size.z) * 1000},
+                      {(center.x + size.x) * 1000, (center.y + size.y) * 1000,
+                       (center.z + size.z) * 1000},
+                      config.bypass};
+    filters_points |= !config.bypass;
+  }
+
+  __host__ __device__ bool contains(int zone, position pos) const {
+    const auto &box = boxes[zone];
+    return pos.x >= box.min.x && pos.x <= box.max.x && pos.y >= box.min.y &&
+           pos.y <= box.max.y && pos.z >= box.min.z && pos.z <= box.max.z;
+  }
+};
+
+// only the first zone_count entries are ever initialised or read
+struct RangeFilterZoneTotals {
+  RangeFilterZoneStats zones[RangeFilterZones::capacity];
+
+  __host__ __device__ static RangeFilterZoneTotals empty(int zone_count) {
+    RangeFilterZoneTotals totals;
+    for (int i = 0; i < zone_count; i++) {
+      totals.zones[i] = {0, 0, 32767, -32768, 32767, -32768, 32767, -32768};
+    }
+    return totals;
+  }
+};
+
+// per-point contribution to every zone's statistics
+struct classify_range_zones {
+  RangeFilterZones zones;
+
+  __host__ __device__ RangeFilterZoneTotals
+  operator()(indexed_point_t point) const {
+    const position pos = thrust::get<0>(point);
+    auto totals = RangeFilterZoneTotals::empty(zones.count);
+    for (int i = 0; i < zones.count; i++) {
+      auto &zone = totals.zones[i];
+      zone.reached_count = 1;
+      if (!zones.contains(i, pos)) {
+        if (zones.boxes[i].bypass) continue;
+        // removed here, so it never reaches the zones after this one
+        break;
+      }
+      zone.fill_count = 1;
+      zone.min_x = zone.max_x = pos.x;
+      zone.min_y = zone.max_y = pos.y;
+      zone.min_z = zone.max_z = pos.z;
+    }
+    return totals;
+  }
+};
+
+struct merge_range_zones {
+  int zone_count;
+
+  __host__ __device__ RangeFilterZoneTotals
+  operator()(const RangeFilterZoneTotals &lhs,
+             const RangeFilterZoneTotals &rhs) const {
+    RangeFilterZoneTotals result = lhs;
+    for (int i = 0; i < zone_count; i++) {
+      auto &zone = result.zones[i];
+      const auto &other = rhs.zones[i];
+      zone.reached_count += other.reached_count;
+      zone.fill_count += other.fill_count;
+      zone.min_x = thrust::min(zone.min_x, other.min_x);
+      zone.max_x = thrust::max(zone.max_x, other.max_x);
+      zone.min_y = thrust::min(zone.min_y, other.min_y);
+      zone.max_y = thrust::max(zone.max_y, other.max_y);
+      zone.min_z = thrust::min(zone.min_z, other.min_z);
+      zone.max_z = thrust::max(zone.max_z, other.max_z);
+    }
+    return result;
+  }
+};
+
+// true for points outside any non-bypassed zone
+struct rejected_by_range_zones {
+  RangeFilterZones zones;
+
+  __host__ __device__ bool operator()(indexed_point_t point) const {
+    const position pos = thrust::get<0>(point);
+    for (int i = 0; i < zones.count; i++) {
+      if (!zones.boxes[i].bypass && !zones.contains(i, pos)) return true;
+    }
+    return false;
+  }
+};
+
 } // namespace pc::operators
@@ -55,6 +55,22 @@ struct RangeFilterOperatorConfiguration {
   RangeFilterOperatorMinMaxConfiguration minmax;
 };
 
+// zone statistics need to count the points from every device
+template <>
+inline constexpr OperatorStage
+    operator_stage<RangeFilterOperatorConfiguration> = OperatorStage::PostMerge;
+
+// What one range filter zone saw during a frame, in millimetres
+struct RangeFilterZoneStats {
+  // points that reached this zone, i.e. weren't removed by an earlier zone
+  int reached_count;
+  // points that were inside this zone
+  int fill_count;
+  short min_x, max_x;
+  short min_y, max_y;
+  short min_z, max_z;
+};
+
 struct RangeFilterOperator : Operator {
 
   RangeFilterOperatorConfiguration _config;
@@ -62,23 +78,27 @@ struct RangeFilterOperator : Operator {
   RangeFilterOperator(const RangeFilterOperatorConfiguration &config)
       : _config(config){};
 
-  __device__ bool operator()(indexed_point_t point) const;
+  __host__ __device__ bool operator()(indexed_point_t point) const;
 
   static void init(const RangeFilterOperatorConfiguration &config,
                    Scene3D &scene, DrawableGroup3D &parent_group,
                    Vector3 bounding_box_color);
+
+  // fills the fill and minmax members of the config from a frame's stats
+  static void update_statistics(RangeFilterOperatorConfiguration &config,
+                                const RangeFilterZoneStats &stats);
 };
 
 struct MinMaxXComparator {
-  __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
+  __host__ __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
 };
 
 struct MinMaxYComparator {
-  __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
+  __host__ __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
 };
 
 struct MinMaxZComparator {
-  __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
+  __host__ __device__ bool operator()(indexed_point_t lhs, indexed_point_t rhs) const;
 };
 
 } // namespace pc::operators
@@ -13,7 +13,7 @@ __host__ __device__ static inline float as_rad(float deg) {
   return deg * mult;
 };
 
-__device__ indexed_point_t RotateOperator::operator()(indexed_point_t point) const {
+__host__ __device__ indexed_point_t RotateOperator::operator()(indexed_point_t point) const {
 
   position pos = thrust::get<0>(point);
   color col = thrust::get<1>(point);
@@ -31,9 +31,9 @@ __device__ indexed_point_t RotateOperator::operator()(indexed_point_t point) con
 
   pos_f = q * pos_f;
 
-  position pos_out = { (short)__float2int_rd(pos_f.x()),
-					  (short)__float2int_rd(pos_f.y()),
-					  (short)__float2int_rd(pos_f.z()), 0 };
+  position pos_out = { float_to_short_rd(pos_f.x()),
+					  float_to_short_rd(pos_f.y()),
+					  float_to_short_rd(pos_f.z()), 0 };
 
   return thrust::make_tuple(pos_out, col, thrust::get<2>(point));
 };
@@ -21,7 +21,7 @@ struct RotateOperator : public thrust::unary_function<indexed_point_t, indexed_p
   RotateOperator(const RotateOperatorConfiguration &config)
       : _config(config){};
 
-  __device__ indexed_point_t operator()(indexed_point_t point) const;
+  __host__ __device__ indexed_point_t operator()(indexed_point_t point) const;
 
   static void draw_imgui_controls(RotateOperatorConfiguration& config);
 };
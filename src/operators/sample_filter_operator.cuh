@@ -4,7 +4,7 @@
 
 namespace pc::operators {
 
-__device__ bool SampleFilterOperator::operator()(indexed_point_t point) const {
+__host__ __device__ bool SampleFilterOperator::operator()(indexed_point_t point) const {
   return thrust::get<2>(point) % _config.sample_count == 0;
 };
 
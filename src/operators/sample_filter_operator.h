@@ -20,7 +20,7 @@ struct SampleFilterOperator : public thrust::unary_function<indexed_point_t, ind
   SampleFilterOperator(const SampleFilterOperatorConfiguration &config)
       : _config(config){};
 
-  __device__ bool operator()(indexed_point_t point) const;
+  __host__ __device__ bool operator()(indexed_point_t point) const;
 
   static void draw_imgui_controls(SampleFilterOperatorConfiguration &config);
 };
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "frame_history.h"
+#include "operator_timing.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cuda_runtime_api.h>
+#include <map>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+namespace pc::operators {
+
+struct CudaMemoryResource {
+  static void *allocate(std::size_t bytes) {
+    void *ptr = nullptr;
+    if (cudaMalloc(&ptr, bytes) != cudaSuccess) throw std::bad_alloc();
+    return ptr;
+  }
+  static void free(void *ptr) { cudaFree(ptr); }
+};
+
+struct HostMemoryResource {
+  static void *allocate(std::size_t bytes) {
+    auto ptr = std::malloc(bytes);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+  }
+  static void free(void *ptr) { std::free(ptr); }
+};
+
+struct ScratchStats {
+  // blocks requested from the underlying memory resource. once a pipeline
+  // reaches its high-water mark this stops increasing.
+  std::size_t allocation_count = 0;
+  // bytes currently held, whether borrowed or cached
+  std::size_t bytes_allocated = 0;
+};
+
+// Keeps every block it hands out and reuses it for later requests of the
+// same size or smaller, so operator temporaries stop hitting cudaMalloc or
+// malloc once the working set of a frame has been seen. Memory is only
+// released when the allocator is destroyed.
+//
+// It satisfies Thrust's temporary allocator interface, so it can also be
+// passed to an execution policy (e.g. thrust::cuda::par(allocator)) to cache
+// the temporaries Thrust's own algorithms allocate.
+//
+// Not thread-safe: each allocator belongs to one processing thread.
+template <typename MemoryResource> class CachingAllocator {
+public:
+  using value_type = char;
+
+  CachingAllocator() = default;
+  CachingAllocator(const CachingAllocator &) = delete;
+  CachingAllocator &operator=(const CachingAllocator &) = delete;
+
+  ~CachingAllocator() {
+    for (auto [bytes, ptr] : _free_blocks) MemoryResource::free(ptr);
+    for (auto [ptr, bytes] : _borrowed_blocks) MemoryResource::free(ptr);
+  }
+
+  char *allocate(std::ptrdiff_t requested_bytes) {
+    const auto bytes = static_cast<std::size_t>(requested_bytes);
+    // take the smallest cached block that fits
+    auto cached = _free_blocks.lower_bound(bytes);
+    if (cached != _free_blocks.end()) {
+      auto [block_bytes, ptr] = *cached;
+      _free_blocks.erase(cached);
+      _borrowed_blocks.emplace(ptr, block_bytes);
+      return ptr;
+    }
+    auto ptr = static_cast<char *>(MemoryResource::allocate(bytes));
+    _borrowed_blocks.emplace(ptr, bytes);
+    _stats.allocation_count++;
+    _stats.bytes_allocated += bytes;
+    return ptr;
+  }
+
+  void deallocate(char *ptr, std::size_t) {
+    auto borrowed = _borrowed_blocks.find(ptr);
+    if (borrowed == _borrowed_blocks.end()) return;
+    _free_blocks.emplace(borrowed->second, ptr);
+    _borrowed_blocks.erase(borrowed);
+  }
+
+  const ScratchStats &stats() const { return _stats; }
+
+private:
+  std::multimap<std::size_t, char *> _free_blocks;
+  std::unordered_map<char *, std::size_t> _borrowed_blocks;
+  ScratchStats _stats;
+};
+
+using DeviceScratchAllocator = CachingAllocator<CudaMemoryResource>;
+using HostScratchAllocator = CachingAllocator<HostMemoryResource>;
+
+// A typed temporary borrowed from a scratch allocator for the duration of a
+// scope. The memory is uninitialised.
+template <typename T, typename Allocator> class ScratchBuffer {
+public:
+  ScratchBuffer(Allocator &allocator, std::size_t count)
+      : _allocator(allocator), _count(count),
+        _data(reinterpret_cast<T *>(allocator.allocate(bytes()))) {}
+  ~ScratchBuffer() {
+    _allocator.deallocate(reinterpret_cast<char *>(_data), bytes());
+  }
+
+  ScratchBuffer(const ScratchBuffer &) = delete;
+  ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+  T *data() const { return _data; }
+  std::size_t size() const { return _count; }
+
+private:
+  Allocator &_allocator;
+  std::size_t _count;
+  T *_data;
+
+  // never ask for zero bytes, so every borrow has a distinct block
+  std::size_t bytes() const { return _count > 0 ? _count * sizeof(T) : 1; }
+};
+
+// The temporaries used while running operators for one ingest pipeline,
+// the pixel state operators keep between its frames and the timer that
+// measures them. Each pipeline owns one so that devices processing in
+// parallel never share an allocator.
+struct OperatorScratch {
+  DeviceScratchAllocator device;
+  HostScratchAllocator host;
+  FrameHistories history;
+  OperatorTimer timer;
+  // where the points come from, for reporting timings
+  std::string source = "merged";
+
+  ScratchStats stats() const {
+    return {device.stats().allocation_count + host.stats().allocation_count,
+            device.stats().bytes_allocated + host.stats().bytes_allocated};
+  }
+};
+
+} // namespace pc::operators
@@ -10,6 +10,7 @@
 #include "range_filter_operator.gen.h"
 #include "rotate_operator.gen.h"
 #include "sample_filter_operator.gen.h"
+#include "operator_timing.h"
 #include "session_bounding_boxes.h"
 #include <functional>
 #include <optional>
@@ -85,6 +86,10 @@ void SessionOperatorHost::draw_imgui_window() {
   if (ImGui::Button("Add session operator")) {
     ImGui::OpenPopup("Add session operator");
   }
+  ImGui::SameLine();
+  ImGui::Checkbox("Fuse operators", &_config.fuse_operators);
+  ImGui::SameLine();
+  ImGui::Checkbox("Publish timings", &_config.publish_timings);
   ImGui::Spacing();
 
   if (ImGui::BeginPopup("Add session operator")) {
@@ -118,6 +123,10 @@ void SessionOperatorHost::draw_imgui_window() {
 
   std::optional<uid> marked_for_delete;
 
+  // post-merge operators don't run where they sit in the list, so the
+  // operators below one are labelled with where they really run
+  bool post_merge_above = false;
+
   for (auto &operator_config : _config.operators) {
     ImGui::PushID(gui::_parameter_index++);
 
@@ -140,11 +149,41 @@ void SessionOperatorHost::draw_imgui_window() {
 					  next_bounding_box_color());
 	      }
             }
+
+	    if constexpr (std::is_same_v<T, BackgroundOperatorConfiguration>) {
+	      if (ImGui::Button("Relearn")) config.relearn_generation++;
+	    }
+
+	    if constexpr (operator_stage<T> == OperatorStage::PostMerge) {
+	      ImGui::TextDisabled(
+		  "Runs on the merged cloud, after every per-device operator");
+	    } else if (post_merge_above) {
+	      ImGui::TextDisabled("Runs on each device, before the merged "
+				  "cloud operators above it");
+	    }
+
+	    // the last measured pass on each device the operator ran on
+	    for (const auto &[source, timing] :
+		 operator_timings().get(config.id)) {
+	      const auto shared_note =
+		  timing.operator_count > 1
+		      ? fmt::format(" (one pass for {} operators)",
+				    timing.operator_count)
+		      : std::string{};
+	      ImGui::TextDisabled("%s: %.2f ms, %zu -> %zu points%s",
+				  source.c_str(), timing.milliseconds,
+				  timing.points_in, timing.points_out,
+				  shared_note.c_str());
+	    }
           } else {
             config.unfolded = false;
           }
           ImGui::EndGroup();
           ImGui::PopID();
+
+	  if (config.enabled && operator_stage<T> == OperatorStage::PostMerge) {
+	    post_merge_above = true;
+	  }
         },
         operator_config);
     ImGui::PopID();
@@ -1,20 +1,31 @@
 #include "../logger.h"
 #include "../math.h"
+#include "background_operator.cuh"
+#include "cluster_operator.cuh"
 #include "denoise/denoise_operator.cuh"
-#include "denoise/kdtree.h"
-#include "noise_operator.cuh"
-#include "rake_operator.cuh"
+#include "fused_operator.cuh"
 #include "range_filter_operator.cuh"
-#include "rotate_operator.cuh"
-#include "sample_filter_operator.cuh"
 #include "session_operator_host.h"
+#include "temporal_operator.cuh"
+#include "voxel_downsample_operator.cuh"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <numeric>
 #include <thrust/copy.h>
 #include <thrust/count.h>
 #include <thrust/device_vector.h>
 #include <thrust/extrema.h>
+#include <thrust/execution_policy.h>
 #include <thrust/host_vector.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/remove.h>
+#include <thrust/sequence.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <thrust/system/omp/execution_policy.h>
 #include <thrust/transform.h>
 #include <tracy/Tracy.hpp>
+#include <type_traits>
 #include <variant>
 
 // #include <pcl/filters/statistical_outlier_removal.h>
@@ -24,222 +35,213 @@
 
 namespace pc::operators {
 
-operator_in_out_t
-SessionOperatorHost::run_operators(operator_in_out_t begin,
-                                   operator_in_out_t end,
-                                   OperatorHostConfiguration &host_config) {
+template <typename ExecutionPolicy, typename Iterator>
+static Iterator
+run_range_filters(const ExecutionPolicy &policy, Iterator begin, Iterator end,
+                  RangeFilterOperatorConfiguration *const *configs,
+                  int config_count) {
+  RangeFilterZones zones;
+  for (int i = 0; i < config_count; i++) zones.add(*configs[i]);
+
+  const auto totals = thrust::transform_reduce(
+      policy, begin, end, classify_range_zones{zones},
+      RangeFilterZoneTotals::empty(zones.count),
+      merge_range_zones{zones.count});
+
+  for (int i = 0; i < config_count; i++) {
+    auto &config = *configs[i];
+    RangeFilterOperator::update_statistics(config, totals.zones[i]);
+
+    // if (config.fill.publish) {
+      // publisher::publish_all(
+      //     "fill_value", std::array<float, 1>{config.fill.fill_value},
+      //     {"operator", "range_filter", std::to_string(config.id),
+      //      "fill"});
+      // publisher::publish_all(
+      //     "proportion", std::array<float, 1>{config.fill.proportion},
+      //     {"operator", "range_filter", std::to_string(config.id),
+      //      "fill"});
+    // }
+
+    // if (config.minmax.publish) {
+    //   auto &mm = config.minmax;
+    //   auto id = std::to_string(config.id);
+    //   publisher::publish_all(
+    //                       "min_x", std::array<float, 1>{mm.min_x},
+    //                       {"operator", "range_filter", id, "minmax"});
+    //   publisher::publish_all(
+    //                       "max_x", std::array<float, 1>{mm.max_x},
+    //                       {"operator", "range_filter", id, "minmax"});
+    //   publisher::publish_all(
+    //                       "min_y", std::array<float, 1>{mm.min_y},
+    //                       {"operator", "range_filter", id, "minmax"});
+    //   publisher::publish_all(
+    //                       "max_y", std::array<float, 1>{mm.max_y},
+    //                       {"operator", "range_filter", id, "minmax"});
+    //   publisher::publish_all(
+    //                       "min_z", std::array<float, 1>{mm.min_z},
+    //                       {"operator", "range_filter", id, "minmax"});
+    //   publisher::publish_all(
+    //                       "max_z", std::array<float, 1>{mm.max_z},
+    //                       {"operator", "range_filter", id, "minmax"});
+    // }
+  }
+
+  if (zones.filters_points) {
+    end = thrust::remove_if(policy, begin, end,
+                            rejected_by_range_zones{zones});
+  }
+  return end;
+}
+
+// The operator pipeline is written once against a Thrust execution policy and
+// the iterators it runs over, and instantiated for points in GPU memory
+// (thrust::cuda::par) and points in host memory (thrust::omp::par).
+template <typename ExecutionPolicy, typename Iterator>
+static Iterator run_operators_impl(const ExecutionPolicy &policy,
+                                   Iterator begin, Iterator end,
+                                   OperatorHostConfiguration &host_config,
+                                   OperatorScratch &scratch,
+                                   OperatorStage stage, cudaStream_t stream) {
+
+  // temporaries are borrowed from the memory the points are processed in
+  constexpr bool on_device =
+      std::is_same_v<thrust::iterator_system_t<Iterator>,
+                     thrust::device_system_tag>;
+  auto &allocator = [&]() -> auto & {
+    if constexpr (on_device) return scratch.device;
+    else return scratch.host;
+  }();
+
+  // spatial operators share one voxel grid until the points change
+  VoxelGridCache voxel_grids(allocator);
+
+  // adjacent per-point operators are accumulated here and run together when
+  // an operator that needs the whole cloud is reached
+  FusedOperator fused;
+  std::array<uid, FusedOperator::capacity> fused_ids;
+  int pass_count = 0;
+  std::chrono::steady_clock::duration fused_time{};
+
+  // likewise adjacent range filters share one classification pass
+  std::array<RangeFilterOperatorConfiguration *, RangeFilterZones::capacity>
+      range_filters;
+  std::array<uid, RangeFilterZones::capacity> range_filter_ids;
+  int range_filter_count = 0;
+
+  // every pass is timed, and its points in and out recorded, against the
+  // operators that ran in it
+  const auto point_count = [&] {
+    return static_cast<std::size_t>(thrust::distance(begin, end));
+  };
+
+  const auto run_pending = [&] {
+    if (!fused.empty()) {
+      ZoneScopedN("FusedOperator");
+      const auto start_time = std::chrono::steady_clock::now();
+      scratch.timer.start(on_device, point_count(), stream);
+      end = run_fused(policy, begin, end, fused);
+      scratch.timer.stop(point_count(),
+                         {fused_ids.data(),
+                          static_cast<std::size_t>(fused.step_count())});
+      fused_time += std::chrono::steady_clock::now() - start_time;
+      pass_count++;
+      fused.clear();
+      voxel_grids.invalidate();
+    }
+    if (range_filter_count > 0) {
+      ZoneScopedN("RangeFilterZones");
+      scratch.timer.start(on_device, point_count(), stream);
+      end = run_range_filters(policy, begin, end, range_filters.data(),
+                              range_filter_count);
+      scratch.timer.stop(point_count(),
+                         {range_filter_ids.data(),
+                          static_cast<std::size_t>(range_filter_count)});
+      pass_count++;
+      range_filter_count = 0;
+      voxel_grids.invalidate();
+    }
+  };
 
   for (auto &operator_config : host_config.operators) {
     std::visit(
-        [&begin, &end](auto &&config) {
-          if (!config.enabled) {
-            return;
-          }
-
+        [&](auto &&config) {
           using T = std::decay_t<decltype(config)>;
 
-          ZoneScopedN(T::Name);
-
-          // Transform operators
-          if constexpr (std::is_same_v<T, NoiseOperatorConfiguration>) {
-            thrust::transform(begin, end, begin, NoiseOperator{config});
-          } else if constexpr (std::is_same_v<T, RotateOperatorConfiguration>) {
-            thrust::transform(begin, end, begin, RotateOperator(config));
-          } else if constexpr (std::is_same_v<T, RakeOperatorConfiguration>) {
-            thrust::transform(begin, end, begin, RakeOperator(config));
+          if (!config.enabled || operator_stage<T> != stage) {
+            return;
           }
 
-          // Filters
-          else if constexpr (std::is_same_v<
-                                 T, SampleFilterOperatorConfiguration>) {
-            end = thrust::copy_if(begin, end, begin,
-                                  SampleFilterOperator(config));
+          if constexpr (FusedOperator::can_fuse<T>) {
+            if (range_filter_count > 0 || fused.full()) run_pending();
+            fused_ids[fused.step_count()] = config.id;
+            fused.push(config);
+            // with fusion turned off every operator runs as its own pass,
+            // which is useful for comparing the cost of each
+            if (!host_config.fuse_operators) run_pending();
+            return;
           }
 
-	  //
-
-	  else if constexpr (std::is_same_v<T, DenoiseOperatorConfiguration>) {
-
-	    pc::logger->info("Building KDTree");
-
-	    // - copy the positions from the operator_in_out_t onto the CPU into a kdNode[]
-	    // -- first get the positions
-	    thrust::device_vector<pc::types::position> gpu_positions;
-	    gpu_positions.reserve(thrust::distance(begin, end));
-	    thrust::transform(begin, end, gpu_positions.begin(),
-			      get_position{});
-
-	    cudaDeviceSynchronize();
-
-            // -- copy them onto the CPU
-	    std::vector<pc::types::position> cpu_positions(
-		gpu_positions.begin(), gpu_positions.end());
-
-            // - create our kdNode vector
-            std::vector<DynaMap::kdNode> kd_nodes(cpu_positions.size());
-
-	    // does the copy need to be parallelized?
-	    for (int i = 0; i < cpu_positions.size(); i++) {
-	      kd_nodes[i] = {.id = i, .left = nullptr, .right = nullptr};
-	      kd_nodes[i].x[0] = cpu_positions[i].x / 1000.0f;
-	      kd_nodes[i].x[1] = cpu_positions[i].y / 1000.0f;
-	      kd_nodes[i].x[2] = cpu_positions[i].z / 1000.0f;
-	    }
-	    if (cpu_positions.size() > 1000) {
-              pc::logger->info("cpu[1000].x: {}", cpu_positions.at(1000).x);
+          if constexpr (std::is_same_v<T, RangeFilterOperatorConfiguration>) {
+            if (!fused.empty() ||
+                range_filter_count == RangeFilterZones::capacity) {
+              run_pending();
             }
+            range_filter_ids[range_filter_count] = config.id;
+            range_filters[range_filter_count++] = &config;
+            if (!host_config.fuse_operators) run_pending();
+            return;
+          }
 
-            // - create the kdtree
-	    DynaMap::kdTree tree;
-	    tree.kdRoot =
-		tree.buildTree(kd_nodes.data(), kd_nodes.size(), 0, MAX_DIM);
-
-            pc::logger->info("Successfully built KDTree: {}",
-                             tree.kdRoot == nullptr ? "false" : "true");
+          run_pending();
+          pass_count++;
 
-            // DenoiseOperator kernel, passing in a reference or pointer to the tree
-	    
-	    // - kernel output still returns a filtered set into begin and end
+          ZoneScopedN(T::Name);
+          scratch.timer.start(on_device, point_count(), stream);
+
+	  if constexpr (std::is_same_v<T, DenoiseOperatorConfiguration>) {
+	    const auto start_time = std::chrono::steady_clock::now();
+	    const auto denoised_end =
+		run_denoise(policy, voxel_grids, begin, end, config);
+	    if (denoised_end != end) voxel_grids.invalidate();
+	    end = denoised_end;
+	    TracyPlot("Denoise ms",
+		      std::chrono::duration<double, std::milli>(
+			  std::chrono::steady_clock::now() - start_time)
+			  .count());
+	  } else if constexpr (std::is_same_v<T,
+					      TemporalOperatorConfiguration>) {
+	    const auto pixel_count = scratch.history.pixel_count;
+	    if (pixel_count > 0) {
+	      end = run_temporal(policy, scratch.history.temporal(config.id),
+				 pixel_count, begin, end, config);
+	      voxel_grids.invalidate();
+	    }
+	  } else if constexpr (std::is_same_v<
+				   T, BackgroundOperatorConfiguration>) {
+	    const auto pixel_count = scratch.history.pixel_count;
+	    if (pixel_count > 0) {
+	      const auto point_count = thrust::distance(begin, end);
+	      end = run_background(policy, scratch.history.background(config.id),
+				   pixel_count, begin, end, config);
+	      voxel_grids.invalidate();
+	      TracyPlot("Background points removed",
+			static_cast<int64_t>(point_count -
+					     thrust::distance(begin, end)));
+	    }
+	  } else if constexpr (std::is_same_v<T,
+					      ClusterOperatorConfiguration>) {
+	    auto clusters = run_clusters(policy, voxel_grids, begin, end, config);
+	    ClusterOperator::track(config, clusters);
+	    if (config.publish) ClusterOperator::publish(config, clusters);
+	    TracyPlot("Clusters", static_cast<int64_t>(clusters.size()));
+	  } else if constexpr (std::is_same_v<
+				   T, VoxelDownsampleOperatorConfiguration>) {
+	    end = run_voxel_downsample(policy, voxel_grids, begin, end, config);
+	    voxel_grids.invalidate();
+	    TracyPlot("Voxel downsample points",
+		      static_cast<int64_t>(thrust::distance(begin, end)));
 	  }
-	    //
-	  else if constexpr (std::is_same_v<
-                                   T, RangeFilterOperatorConfiguration>) {
-
-	    // TODO: this is RangeFilter Operator behaviour,
-	    // probs needs to be inside that class somehow
-
-            // the operator host should really not contain logic relating to
-            // individual operators, it should simply call them
-
-            // perhaps we completely replace the thrust::copy_if with an
-            // operator calling function that returns a new end if the config
-            // requires it
-
-            auto starting_point_count = thrust::distance(begin, end);
-
-            thrust::device_vector<position> filtered_positions(
-                starting_point_count);
-            thrust::device_vector<color> filtered_colors(starting_point_count);
-            thrust::device_vector<int> filtered_indices(starting_point_count);
-
-            auto filtered_begin = thrust::make_zip_iterator(thrust::make_tuple(
-                filtered_positions.begin(), filtered_colors.begin(),
-                filtered_indices.begin()));
-            auto filtered_end = thrust::copy_if(begin, end, filtered_begin,
-                                                RangeFilterOperator{config});
-
-            auto &fill_count = config.fill.fill_count;
-            fill_count = thrust::distance(filtered_begin, filtered_end);
-
-            if (!config.bypass) {
-              end = thrust::copy(filtered_begin, filtered_end, begin);
-            }
-
-            if (fill_count > config.fill.count_threshold) {
-
-              config.fill.fill_value =
-                  fill_count / static_cast<float>(config.fill.max_fill);
-              config.fill.proportion =
-                  fill_count / static_cast<float>(starting_point_count);
-
-            auto minmax_x_points = thrust::minmax_element(
-                filtered_begin, filtered_end, MinMaxXComparator{});
-            auto minmax_y_points = thrust::minmax_element(
-                filtered_begin, filtered_end, MinMaxYComparator{});
-            auto minmax_z_points = thrust::minmax_element(
-							  filtered_begin, filtered_end, MinMaxZComparator{});
-
-	    const auto &min_x =
-	      thrust::get<0>(*minmax_x_points.first).operator position().x /
-	      1000.0f;
-	    const auto &max_x = thrust::get<0>(*minmax_x_points.second)
-	      .
-	      operator position()
-	      .x /
-	      1000.0f;
-	    const auto &min_y =
-	      thrust::get<0>(*minmax_y_points.first).operator position().y /
-	      1000.0f;
-	    const auto &max_y = thrust::get<0>(*minmax_y_points.second)
-	      .
-	      operator position()
-	      .y /
-	      1000.0f;
-	    const auto &min_z =
-	      thrust::get<0>(*minmax_z_points.first).operator position().z /
-	      1000.0f;
-	    const auto &max_z = thrust::get<0>(*minmax_z_points.second)
-	      .
-	      operator position()
-	      .z /
-	      1000.0f;
-
-	    float box_min_x = config.position.x - config.size.x;
-	    float box_max_x = config.position.x + config.size.x;
-	    float box_min_y = config.position.y - config.size.y;
-	    float box_max_y = config.position.y + config.size.y;
-	    float box_min_z = config.position.z - config.size.z;
-	    float box_max_z = config.position.z + config.size.z;
-
-	    config.minmax.min_x = pc::math::remap(box_min_x, box_max_x, 0.0f,
-						  1.0f, min_x, true);
-	    config.minmax.max_x = pc::math::remap(box_min_x, box_max_x, 0.0f,
-						  1.0f, max_x, true);
-	    config.minmax.min_y = pc::math::remap(box_min_y, box_max_y, 0.0f,
-						  1.0f, min_y, true);
-	    config.minmax.max_y = pc::math::remap(box_min_y, box_max_y, 0.0f,
-						  1.0f, max_y, true);
-	    config.minmax.min_z = pc::math::remap(box_min_z, box_max_z, 0.0f,
-						  1.0f, min_z, true);
-	    config.minmax.max_z = pc::math::remap(box_min_z, box_max_z, 0.0f,
-						  1.0f, max_z, true);
-
-	    } else {
-	      config.fill.fill_value = 0;
-	      config.fill.proportion = 0;
-	      config.minmax.min_x = 0;
-	      config.minmax.max_x = 0;
-	      config.minmax.min_y = 0;
-	      config.minmax.max_y = 0;
-	      config.minmax.min_z = 0;
-	      config.minmax.max_z = 0;
-            }
-
-            // if (config.fill.publish) {
-              // publisher::publish_all(
-              //     "fill_value", std::array<float, 1>{config.fill.fill_value},
-              //     {"operator", "range_filter", std::to_string(config.id),
-              //      "fill"});
-              // publisher::publish_all(
-              //     "proportion", std::array<float, 1>{config.fill.proportion},
-              //     {"operator", "range_filter", std::to_string(config.id),
-              //      "fill"});
-            // }
-
-            // TODO these three kernels could probably be fused into one
-	    // if (config.minmax.publish) {
-	    //   auto &mm = config.minmax;
-	    //   auto id = std::to_string(config.id);
-	    //   publisher::publish_all(
-	    // 			     "min_x", std::array<float, 1>{mm.min_x},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    //   publisher::publish_all(
-	    // 			     "max_x", std::array<float, 1>{mm.max_x},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    //   publisher::publish_all(
-	    // 			     "min_y", std::array<float, 1>{mm.min_y},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    //   publisher::publish_all(
-	    // 			     "max_y", std::array<float, 1>{mm.max_y},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    //   publisher::publish_all(
-	    // 			     "min_z", std::array<float, 1>{mm.min_z},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    //   publisher::publish_all(
-	    // 			     "max_z", std::array<float, 1>{mm.max_z},
-	    // 			     {"operator", "range_filter", id, "minmax"});
-	    // }
-          }
           // else if constexpr (std::is_same_v<
           //                        T, OutlierFilterOperatorConfiguration>) {
           // if (config.enabled) {
@@ -281,19 +283,174 @@ SessionOperatorHost::run_operators(operator_in_out_t begin,
 
           // }
           // }
+
+          const uid operator_id = config.id;
+          scratch.timer.stop(point_count(), {&operator_id, 1});
         },
         operator_config);
   }
 
+  run_pending();
+  scratch.timer.flush(scratch.source, host_config.publish_timings);
+
+  TracyPlot("Operator passes", static_cast<int64_t>(pass_count));
+  TracyPlot("Fused operator ms",
+            std::chrono::duration<double, std::milli>(fused_time).count());
+
   return end;
 };
 
+// Thrust's own temporaries (e.g. for copy_if and minmax_element) are
+// allocated through the scratch allocators too
+
+operator_in_out_t
+SessionOperatorHost::run_operators(operator_in_out_t begin,
+                                   operator_in_out_t end,
+                                   OperatorHostConfiguration &host_config,
+                                   OperatorScratch &scratch,
+                                   OperatorStage stage, cudaStream_t stream) {
+  return run_operators_impl(thrust::cuda::par(scratch.device).on(stream),
+                            begin, end, host_config, scratch, stage, stream);
+}
+
+operator_host_in_out_t
+SessionOperatorHost::run_operators(operator_host_in_out_t begin,
+                                   operator_host_in_out_t end,
+                                   OperatorHostConfiguration &host_config,
+                                   OperatorScratch &scratch,
+                                   OperatorStage stage) {
+  // host passes are timed on the clock, so there's no stream
+  return run_operators_impl(thrust::omp::par(scratch.host), begin, end,
+                            host_config, scratch, stage, nullptr);
+}
+
+struct MergedOperatorMemory {
+  bool use_cuda;
+  thrust::device_vector<position> positions;
+  thrust::device_vector<color> colors;
+  thrust::device_vector<int> indices;
+  std::vector<int> host_indices;
+  OperatorScratch scratch;
+
+  MergedOperatorMemory() {
+    int device_count = 0;
+    use_cuda =
+        cudaGetDeviceCount(&device_count) == cudaSuccess && device_count > 0;
+  }
+};
+
+SessionOperatorHost::~SessionOperatorHost() { delete _merged_memory; }
+
+FrameHistories::~FrameHistories() {
+  for (auto [id, history] : _temporal) delete history;
+  for (auto [id, model] : _background) delete model;
+}
+
+TemporalHistory &FrameHistories::temporal(uid operator_id) {
+  auto &history = _temporal[operator_id];
+  if (history == nullptr) history = new TemporalHistory();
+  return *history;
+}
+
+BackgroundModel &FrameHistories::background(uid operator_id) {
+  auto &model = _background[operator_id];
+  if (model == nullptr) model = new BackgroundModel();
+  return *model;
+}
+
+bool SessionOperatorHost::has_post_merge_operators() const {
+  return std::any_of(
+      _config.operators.begin(), _config.operators.end(),
+      [](const auto &operator_config) {
+        return std::visit(
+            [](const auto &config) {
+              using T = std::decay_t<decltype(config)>;
+              return config.enabled &&
+                     operator_stage<T> == OperatorStage::PostMerge;
+            },
+            operator_config);
+      });
+}
+
+void SessionOperatorHost::run_post_merge(pc::types::PointCloud &cloud) const {
+  // most sessions have no post-merge operators, and then there's no reason
+  // to move the merged cloud anywhere
+  if (!has_post_merge_operators()) return;
+
+  ZoneScopedN("SessionOperatorHost::run_post_merge");
+
+  if (_merged_memory == nullptr) _merged_memory = new MergedOperatorMemory();
+  auto &memory = *_merged_memory;
+
+  const std::size_t point_count = cloud.positions.size();
+  std::size_t output_point_count;
+
+  if (memory.use_cuda) {
+    // device vectors only grow, so after the first few frames this doesn't
+    // allocate
+    if (memory.positions.size() < point_count) {
+      memory.positions.resize(point_count);
+      memory.colors.resize(point_count);
+      memory.indices.resize(point_count);
+    }
+    thrust::copy(cloud.positions.begin(), cloud.positions.end(),
+                 memory.positions.begin());
+    thrust::copy(cloud.colors.begin(), cloud.colors.end(),
+                 memory.colors.begin());
+    thrust::sequence(memory.indices.begin(),
+                     memory.indices.begin() + point_count);
+
+    auto begin = thrust::make_zip_iterator(thrust::make_tuple(
+        memory.positions.begin(), memory.colors.begin(),
+        memory.indices.begin()));
+    // the merged stage runs on its own, so the default stream is fine
+    auto end = run_operators(begin, begin + point_count, _config,
+                             memory.scratch, OperatorStage::PostMerge, 0);
+    output_point_count = thrust::distance(begin, end);
+
+    thrust::copy(memory.positions.begin(),
+                 memory.positions.begin() + output_point_count,
+                 cloud.positions.begin());
+    thrust::copy(memory.colors.begin(),
+                 memory.colors.begin() + output_point_count,
+                 cloud.colors.begin());
+  } else {
+    // on the host the merged cloud can be processed where it is
+    memory.host_indices.resize(point_count);
+    std::iota(memory.host_indices.begin(), memory.host_indices.end(), 0);
+
+    auto begin = thrust::make_zip_iterator(
+        thrust::make_tuple(cloud.positions.data(), cloud.colors.data(),
+                           memory.host_indices.data()));
+    auto end = run_operators(begin, begin + point_count, _config,
+                             memory.scratch, OperatorStage::PostMerge);
+    output_point_count = thrust::distance(begin, end);
+  }
+
+  cloud.positions.resize(output_point_count);
+  cloud.colors.resize(output_point_count);
+}
+
 operator_in_out_t apply(operator_in_out_t begin, operator_in_out_t end,
-                        const OperatorList &operator_list) {
+                        const OperatorList &operator_list,
+                        OperatorScratch &scratch, cudaStream_t stream) {
+  for (auto &operator_host_ref : operator_list) {
+    auto &operator_host = operator_host_ref.get();
+    end = pc::operators::SessionOperatorHost::run_operators(
+        begin, end, operator_host._config, scratch, OperatorStage::PerDevice,
+        stream);
+  }
+  return end;
+}
+
+operator_host_in_out_t apply(operator_host_in_out_t begin,
+                             operator_host_in_out_t end,
+                             const OperatorList &operator_list,
+                             OperatorScratch &scratch) {
   for (auto &operator_host_ref : operator_list) {
     auto &operator_host = operator_host_ref.get();
     end = pc::operators::SessionOperatorHost::run_operators(
-        begin, end, operator_host._config);
+        begin, end, operator_host._config, scratch, OperatorStage::PerDevice);
   }
   return end;
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "../structs.h"
 #include "operator_host_config.gen.h"
+#include "scratch_allocator.h"
 #include <functional>
 #include <optional>
 #include <vector>
@@ -9,6 +10,9 @@
 
 namespace pc::operators {
 
+// Forward declaration hides CUDA types from TUs not compiled with nvcc
+struct MergedOperatorMemory;
+
 using Scene3D =
     Magnum::SceneGraph::Scene<Magnum::SceneGraph::MatrixTransformation3D>;
 using Object3D =
@@ -17,12 +21,33 @@ using Object3D =
 class SessionOperatorHost {
 public:
 
+  // runs the operators belonging to the given stage, issuing their work on
+  // the given stream. temporaries are borrowed from scratch, which must not
+  // be shared with another thread running operators at the same time
   static operator_in_out_t run_operators(operator_in_out_t begin,
 					 operator_in_out_t end,
-					 OperatorHostConfiguration &host_config);
+					 OperatorHostConfiguration &host_config,
+					 OperatorScratch &scratch,
+					 OperatorStage stage,
+					 cudaStream_t stream);
+
+  // runs the same operators over points in host memory across all CPU cores
+  static operator_host_in_out_t
+  run_operators(operator_host_in_out_t begin, operator_host_in_out_t end,
+		OperatorHostConfiguration &host_config,
+		OperatorScratch &scratch, OperatorStage stage);
 
   SessionOperatorHost(OperatorHostConfiguration &config, Scene3D &scene,
 		      Magnum::SceneGraph::DrawableGroup3D &parent_group);
+  ~SessionOperatorHost();
+
+  SessionOperatorHost(const SessionOperatorHost &) = delete;
+  SessionOperatorHost &operator=(const SessionOperatorHost &) = delete;
+
+  // runs the post-merge operators over the merged cloud of every device,
+  // so that their statistics cover the whole scene. only call from one
+  // thread at a time.
+  void run_post_merge(pc::types::PointCloud &cloud) const;
 
   void draw_imgui_window();
 
@@ -32,6 +57,11 @@ private:
   Scene3D &_scene;
   Magnum::SceneGraph::DrawableGroup3D &_parent_group;
 
+  // allocated on the first post-merge run
+  mutable MergedOperatorMemory *_merged_memory = nullptr;
+
+  bool has_post_merge_operators() const;
+
   void add_operator(OperatorConfigurationVariant operator_config) {
     _config.operators.push_back(operator_config);
   }
@@ -40,7 +70,15 @@ private:
 using OperatorList =
     std::vector<std::reference_wrapper<const SessionOperatorHost>>;
 
+// runs the per-device stage of every operator host in the list on the
+// device's stream
 extern operator_in_out_t apply(operator_in_out_t begin, operator_in_out_t end,
-			       const OperatorList& operator_list); 
+			       const OperatorList& operator_list,
+			       OperatorScratch &scratch, cudaStream_t stream);
+
+extern operator_host_in_out_t apply(operator_host_in_out_t begin,
+				    operator_host_in_out_t end,
+				    const OperatorList &operator_list,
+				    OperatorScratch &scratch);
 
 } // namespace pc::operators
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "../structs.h"
+#include "frame_history.h"
+#include "temporal_operator.gen.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thrust/copy.h>
+#include <thrust/device_vector.h>
+#include <thrust/fill.h>
+#include <thrust/host_vector.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/iterator_traits.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/transform.h>
+#include <type_traits>
+
+namespace pc::operators {
+
+using pc::types::color;
+using pc::types::position;
+
+// what a temporal operator remembers about each depth pixel
+struct TemporalPixel {
+  // the position output for the pixel last frame. kept in float so that
+  // exponential smoothing doesn't lose small movements to rounding.
+  float x, y, z;
+  color last_color;
+  // the frame the pixel was last seen in. frames start at 1 so that zero
+  // means never.
+  std::uint32_t last_seen;
+};
+
+// Per-pixel state plus, for median mode, a ring of the last frame_count
+// positions of every pixel. Slot (frame % frame_count) of the ring is
+// written each frame, and each entry is stamped with its frame so entries
+// from frames the pixel was missing in are ignored without ever clearing
+// the ring.
+template <template <typename...> class Vector> struct TemporalRing {
+  Vector<TemporalPixel> pixels;
+  Vector<position> ring_positions;
+  Vector<std::uint32_t> ring_stamps;
+  int frame_count = 0;
+
+  // storage only changes size when the device or the operator's frame count
+  // changes, which also discards the history
+  void reserve(std::size_t pixel_count, int ring_frame_count) {
+    if (pixels.size() != pixel_count) {
+      pixels.resize(pixel_count);
+      thrust::fill(pixels.begin(), pixels.end(), TemporalPixel{});
+      frame_count = 0;
+    }
+    if (frame_count != ring_frame_count) {
+      ring_positions.resize(pixel_count * ring_frame_count);
+      ring_stamps.resize(pixel_count * ring_frame_count);
+      thrust::fill(ring_stamps.begin(), ring_stamps.end(), 0);
+      frame_count = ring_frame_count;
+    }
+  }
+
+  void clear() {
+    thrust::fill(pixels.begin(), pixels.end(), TemporalPixel{});
+    thrust::fill(ring_stamps.begin(), ring_stamps.end(), 0);
+  }
+};
+
+struct TemporalHistory {
+  std::uint32_t frame = 0;
+  // the history is only continuous within one backend
+  bool last_on_device = false;
+  TemporalRing<thrust::device_vector> device;
+  TemporalRing<thrust::host_vector> host;
+};
+
+struct temporal_update {
+  TemporalPixel *pixels;
+  position *ring_positions;
+  std::uint32_t *ring_stamps;
+  int pixel_count;
+  int ring_frame_count;
+  std::uint32_t frame;
+  TemporalMode mode;
+  float smoothing;
+  float jump_threshold;
+
+  __host__ __device__ static short median_of(short *values, int count) {
+    for (int i = 1; i < count; i++) {
+      const auto value = values[i];
+      int j = i;
+      while (j > 0 && values[j - 1] > value) {
+        values[j] = values[j - 1];
+        j--;
+      }
+      values[j] = value;
+    }
+    return values[count / 2];
+  }
+
+  __host__ __device__ indexed_point_t operator()(indexed_point_t point) const {
+    const int pixel = thrust::get<2>(point);
+    if (pixel < 0 || pixel >= pixel_count) return point;
+
+    auto pos = thrust::get<0>(point);
+    auto &state = pixels[pixel];
+    const bool continuous =
+        state.last_seen != 0 && state.last_seen + 1 == frame;
+
+    if (mode == TemporalMode::Median) {
+      const int slot = frame % ring_frame_count;
+      ring_positions[slot * pixel_count + pixel] = pos;
+      ring_stamps[slot * pixel_count + pixel] = frame;
+
+      short xs[TemporalOperator::max_frame_count];
+      short ys[TemporalOperator::max_frame_count];
+      short zs[TemporalOperator::max_frame_count];
+      int count = 0;
+      for (int i = 0; i < ring_frame_count; i++) {
+        const auto stamp = ring_stamps[i * pixel_count + pixel];
+        if (stamp == 0 ||
+            frame - stamp >= static_cast<std::uint32_t>(ring_frame_count))
+          continue;
+        const auto stored = ring_positions[i * pixel_count + pixel];
+        xs[count] = stored.x;
+        ys[count] = stored.y;
+        zs[count] = stored.z;
+        count++;
+      }
+      pos.x = median_of(xs, count);
+      pos.y = median_of(ys, count);
+      pos.z = median_of(zs, count);
+      state.x = pos.x;
+      state.y = pos.y;
+      state.z = pos.z;
+    } else {
+      const float dx = pos.x - state.x;
+      const float dy = pos.y - state.y;
+      const float dz = pos.z - state.z;
+      if (continuous && fabsf(dx) < jump_threshold &&
+          fabsf(dy) < jump_threshold && fabsf(dz) < jump_threshold) {
+        state.x += smoothing * dx;
+        state.y += smoothing * dy;
+        state.z += smoothing * dz;
+      } else {
+        state.x = pos.x;
+        state.y = pos.y;
+        state.z = pos.z;
+      }
+      pos.x = float_to_short_rd(state.x + 0.5f);
+      pos.y = float_to_short_rd(state.y + 0.5f);
+      pos.z = float_to_short_rd(state.z + 0.5f);
+    }
+
+    state.last_color = thrust::get<1>(point);
+    state.last_seen = frame;
+    return thrust::make_tuple(pos, state.last_color, pixel);
+  }
+};
+
+struct temporal_is_persisting {
+  const TemporalPixel *pixels;
+  std::uint32_t frame;
+  std::uint32_t persistence_frames;
+
+  __host__ __device__ bool operator()(int pixel) const {
+    const auto last_seen = pixels[pixel].last_seen;
+    return last_seen != 0 && last_seen != frame &&
+           frame - last_seen <= persistence_frames;
+  }
+};
+
+struct temporal_persisted_point {
+  const TemporalPixel *pixels;
+  std::uint32_t frame;
+  float decay;
+
+  __host__ __device__ indexed_point_t operator()(int pixel) const {
+    const auto &state = pixels[pixel];
+    const auto age = static_cast<float>(frame - state.last_seen);
+    const float fade = powf(decay, age);
+    position pos = {float_to_short_rd(state.x + 0.5f),
+                    float_to_short_rd(state.y + 0.5f),
+                    float_to_short_rd(state.z + 0.5f), 0};
+    color col = state.last_color;
+    col.r = static_cast<std::uint8_t>(col.r * fade);
+    col.g = static_cast<std::uint8_t>(col.g * fade);
+    col.b = static_cast<std::uint8_t>(col.b * fade);
+    return thrust::make_tuple(pos, col, pixel);
+  }
+};
+
+// Smooths the points between begin and end against the pixel history and
+// returns the new end. With persistence, pixels that dropped out this frame
+// are appended after the points that arrived, so the range the iterators
+// point into must have room for one point per pixel (which the ingest
+// pipeline's output buffers always do).
+template <typename ExecutionPolicy, typename Iterator>
+Iterator run_temporal(const ExecutionPolicy &policy, TemporalHistory &history,
+                      std::size_t pixel_count, Iterator begin, Iterator end,
+                      const TemporalOperatorConfiguration &config) {
+  constexpr bool on_device =
+      std::is_same_v<thrust::iterator_system_t<Iterator>,
+                     thrust::device_system_tag>;
+  auto &ring = [&]() -> auto & {
+    if constexpr (on_device) return history.device;
+    else return history.host;
+  }();
+
+  const auto mode = static_cast<TemporalMode>(config.mode);
+  const int ring_frame_count =
+      mode == TemporalMode::Median
+          ? std::clamp(config.frame_count, 1, TemporalOperator::max_frame_count)
+          : 0;
+  ring.reserve(pixel_count, ring_frame_count);
+
+  if (history.frame > 0 && history.last_on_device != on_device) ring.clear();
+  history.last_on_device = on_device;
+  const auto frame = ++history.frame;
+
+  const auto pixels = thrust::raw_pointer_cast(ring.pixels.data());
+
+  thrust::transform(
+      policy, begin, end, begin,
+      temporal_update{pixels, thrust::raw_pointer_cast(ring.ring_positions.data()),
+                      thrust::raw_pointer_cast(ring.ring_stamps.data()),
+                      static_cast<int>(pixel_count), ring_frame_count, frame,
+                      mode, config.smoothing, config.jump_threshold});
+
+  if (config.persistence_frames <= 0) return end;
+
+  const auto pixels_begin = thrust::make_counting_iterator(0);
+  return thrust::copy_if(
+      policy,
+      thrust::make_transform_iterator(
+          pixels_begin, temporal_persisted_point{pixels, frame, config.decay}),
+      thrust::make_transform_iterator(
+          pixels_begin + pixel_count,
+          temporal_persisted_point{pixels, frame, config.decay}),
+      pixels_begin, end,
+      temporal_is_persisting{
+          pixels, frame, static_cast<std::uint32_t>(config.persistence_frames)});
+}
+
+} // namespace pc::operators
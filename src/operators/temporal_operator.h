@@ -0,0 +1,37 @@
+#pragma once
+#include "../serialization.h"
+#include "operator.h"
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+// Temporal runs on each device's cloud before it's merged, where every
+// point's index is still the depth pixel it came from, so a pixel can be
+// followed from one frame to the next.
+struct TemporalOperatorConfiguration {
+  uid id;
+  bool enabled = true;
+  int mode = 0; // 0: exponential smoothing, 1: median of frames
+  // exponential smoothing: how much of each new frame is mixed into a
+  // pixel's smoothed position
+  float smoothing = 0.3f; // @minmax(0.01, 1)
+  // a pixel that moves further than this in mm between frames starts
+  // smoothing again from its new position, so real motion doesn't smear
+  float jump_threshold = 50.0f; // @minmax(1, 500)
+  // median mode: how many of each pixel's recent frames are kept
+  int frame_count = 5; // @minmax(2, 16)
+  // pixels that drop out are still output at their last position for this
+  // many frames
+  int persistence_frames = 0; // @minmax(0, 30)
+  // the fraction of a persisting pixel's color kept each frame
+  float decay = 0.8f; // @minmax(0, 1)
+};
+
+enum class TemporalMode { Exponential = 0, Median = 1 };
+
+struct TemporalOperator {
+  static constexpr int max_frame_count = 16;
+};
+
+} // namespace pc::operators
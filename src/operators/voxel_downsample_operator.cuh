@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../structs.h"
+#include "voxel_downsample_operator.gen.h"
+#include "voxel_grid.cuh"
+#include <cstdint>
+#include <thrust/functional.h>
+#include <thrust/iterator/discard_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/reduce.h>
+
+namespace pc::operators {
+
+struct VoxelPointSum {
+  std::int64_t x, y, z;
+  std::uint32_t r, g, b, a;
+  std::uint32_t count;
+};
+
+struct voxel_point_sum_of {
+  __host__ __device__ VoxelPointSum operator()(indexed_point_t point) const {
+    const auto pos = thrust::get<0>(point);
+    const auto col = thrust::get<1>(point);
+    return {pos.x, pos.y, pos.z, col.r, col.g, col.b, col.a, 1};
+  }
+};
+
+struct add_voxel_point_sums {
+  __host__ __device__ VoxelPointSum operator()(const VoxelPointSum &lhs,
+                                               const VoxelPointSum &rhs) const {
+    return {lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z,
+            lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b,
+            lhs.a + rhs.a, lhs.count + rhs.count};
+  }
+};
+
+struct voxel_point_average {
+  __host__ __device__ indexed_point_t operator()(const VoxelPointSum &sum,
+                                                 int cell) const {
+    const float count = static_cast<float>(sum.count);
+    pc::types::position pos;
+    pos.x = float_to_short_rd(sum.x / count + 0.5f);
+    pos.y = float_to_short_rd(sum.y / count + 0.5f);
+    pos.z = float_to_short_rd(sum.z / count + 0.5f);
+    pc::types::color col;
+    col.r = static_cast<std::uint8_t>(sum.r / sum.count);
+    col.g = static_cast<std::uint8_t>(sum.g / sum.count);
+    col.b = static_cast<std::uint8_t>(sum.b / sum.count);
+    col.a = static_cast<std::uint8_t>(sum.a / sum.count);
+    return thrust::make_tuple(pos, col, cell);
+  }
+};
+
+// Replaces the points between begin and end with one point per occupied
+// voxel and returns the new end. The grid has already sorted the points by
+// voxel key, so the averages come from a single reduce_by_key over the
+// sorted order.
+template <typename ExecutionPolicy, typename Allocator, typename Iterator>
+Iterator run_voxel_downsample(const ExecutionPolicy &policy,
+                              VoxelGridCache<Allocator> &voxel_grids,
+                              Iterator begin, Iterator end,
+                              const VoxelDownsampleOperatorConfiguration &config) {
+  const std::size_t point_count = thrust::distance(begin, end);
+  if (point_count == 0) return end;
+
+  const auto grid =
+      voxel_grids.get(policy, begin, end, config.voxel_size).view();
+
+  ScratchBuffer<VoxelPointSum, Allocator> sums(voxel_grids.allocator(),
+                                               grid.cell_count);
+
+  const auto sorted_points = thrust::make_permutation_iterator(
+      begin, grid.sorted_indices);
+  thrust::reduce_by_key(
+      policy, grid.sorted_keys, grid.sorted_keys + point_count,
+      thrust::make_transform_iterator(sorted_points, voxel_point_sum_of{}),
+      thrust::make_discard_iterator(), sums.data(),
+      thrust::equal_to<std::uint64_t>{}, add_voxel_point_sums{});
+
+  // every point has been read into the sums, so the averages can be written
+  // over the start of the input
+  thrust::transform(policy, sums.data(), sums.data() + grid.cell_count,
+                    thrust::make_counting_iterator(0), begin,
+                    voxel_point_average{});
+  return begin + grid.cell_count;
+}
+
+} // namespace pc::operators
@@ -0,0 +1,24 @@
+#pragma once
+#include "../serialization.h"
+#include "operator.h"
+
+namespace pc::operators {
+
+using uid = unsigned long int;
+
+struct VoxelDownsampleOperatorConfiguration {
+  uid id;
+  bool enabled = true;
+  // edge length of each voxel in mm. every occupied voxel is replaced by a
+  // single point at the average position and color of the points inside it
+  float voxel_size = 20.0f; // @minmax(1, 500)
+};
+
+// downsampling the merged cloud also combines the points of overlapping
+// devices that land in the same voxel
+template <>
+inline constexpr OperatorStage
+    operator_stage<VoxelDownsampleOperatorConfiguration> =
+        OperatorStage::PostMerge;
+
+} // namespace pc::operators
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "../structs.h"
+#include "operator.h"
+#include "scratch_allocator.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <thrust/copy.h>
+#include <thrust/fill.h>
+#include <thrust/for_each.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/pair.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/transform.h>
+#include <thrust/unique.h>
+#include <tracy/Tracy.hpp>
+
+namespace pc::operators {
+
+using pc::types::position;
+
+// Read-only view of a built VoxelGrid that can be copied into kernels.
+//
+// Points are bucketed into cubic voxels and sorted by voxel key, so every
+// occupied voxel owns a contiguous range of sorted slots. An open-addressing
+// hash table maps each occupied voxel's key to its cell, so looking up the
+// points in any voxel is constant time regardless of how many voxels are
+// occupied.
+struct VoxelGridView {
+  float voxel_size;
+  int point_count;
+  int cell_count;
+  // the voxel key of each sorted slot
+  const std::uint64_t *sorted_keys;
+  // sorted unique key of each occupied voxel
+  const std::uint64_t *cell_keys;
+  // first sorted slot of each voxel, with cell_starts[cell_count] ==
+  // point_count
+  const int *cell_starts;
+  // the original index of the point in each sorted slot
+  const int *sorted_indices;
+  // positions in sorted slot order, so neighbouring points are adjacent in
+  // memory
+  const position *sorted_positions;
+  // hash table from voxel key to cell, with a power of two capacity
+  int table_capacity;
+  const std::uint64_t *table_keys;
+  const int *table_cells;
+
+  static constexpr int key_bits = 21;
+  static constexpr int key_offset = 1 << (key_bits - 1);
+  static constexpr std::uint64_t empty_key = ~std::uint64_t(0);
+
+  __host__ __device__ static std::uint64_t key(int x, int y, int z) {
+    return (std::uint64_t(z + key_offset) << (2 * key_bits)) |
+           (std::uint64_t(y + key_offset) << key_bits) |
+           std::uint64_t(x + key_offset);
+  }
+
+  __host__ __device__ static void coordinates(std::uint64_t key, int &x,
+                                              int &y, int &z) {
+    constexpr std::uint64_t mask = (std::uint64_t(1) << key_bits) - 1;
+    x = static_cast<int>(key & mask) - key_offset;
+    y = static_cast<int>((key >> key_bits) & mask) - key_offset;
+    z = static_cast<int>((key >> (2 * key_bits)) & mask) - key_offset;
+  }
+
+  // spreads the packed coordinates over the whole word so neighbouring
+  // voxels don't land in neighbouring table slots
+  __host__ __device__ static std::uint64_t hash(std::uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+  }
+
+  __host__ __device__ int cell_coordinate(short value) const {
+    return static_cast<int>(floorf(value / voxel_size));
+  }
+
+  __host__ __device__ std::uint64_t key_of(position pos) const {
+    return key(cell_coordinate(pos.x), cell_coordinate(pos.y),
+               cell_coordinate(pos.z));
+  }
+
+  // index of the occupied cell with the given key, or -1 if the voxel is
+  // empty
+  __host__ __device__ int find_cell(std::uint64_t value) const {
+    const auto mask = static_cast<std::uint64_t>(table_capacity - 1);
+    for (auto slot = hash(value) & mask;; slot = (slot + 1) & mask) {
+      const auto stored = table_keys[slot];
+      if (stored == value) return table_cells[slot];
+      if (stored == empty_key) return -1;
+    }
+  }
+
+  // the sorted slots [first, second) holding the points in a voxel
+  __host__ __device__ thrust::pair<int, int> cell_range(int x, int y,
+                                                        int z) const {
+    const int cell = find_cell(key(x, y, z));
+    if (cell < 0) return {0, 0};
+    return {cell_starts[cell], cell_starts[cell + 1]};
+  }
+
+  // calls func(slot) for every sorted slot in the 3x3x3 voxels around pos
+  template <typename Func>
+  __host__ __device__ void for_each_neighbour_slot(position pos,
+                                                   Func &&func) const {
+    const int x = cell_coordinate(pos.x);
+    const int y = cell_coordinate(pos.y);
+    const int z = cell_coordinate(pos.z);
+    for (int dz = -1; dz <= 1; dz++) {
+      for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+          const auto range = cell_range(x + dx, y + dy, z + dz);
+          for (int slot = range.first; slot < range.second; slot++) {
+            func(slot);
+          }
+        }
+      }
+    }
+  }
+};
+
+struct voxel_key_of {
+  float voxel_size;
+  __host__ __device__ std::uint64_t operator()(indexed_point_t point) const {
+    return VoxelGridView{voxel_size}.key_of(thrust::get<0>(point));
+  }
+};
+
+// Inserts each occupied cell into the hash table. Keys are unique, so the
+// thread that claims a slot is the only one that writes its cell.
+struct insert_voxel_cell {
+  const std::uint64_t *cell_keys;
+  std::uint64_t *table_keys;
+  int *table_cells;
+  int table_capacity;
+
+  __host__ __device__ static bool claim(std::uint64_t *slot,
+                                        std::uint64_t value) {
+    auto expected = VoxelGridView::empty_key;
+#ifdef __CUDA_ARCH__
+    return atomicCAS(reinterpret_cast<unsigned long long *>(slot),
+                     static_cast<unsigned long long>(expected),
+                     static_cast<unsigned long long>(value)) == expected;
+#else
+    return std::atomic_ref<std::uint64_t>(*slot).compare_exchange_strong(
+        expected, value, std::memory_order_relaxed);
+#endif
+  }
+
+  __host__ __device__ void operator()(int cell) const {
+    const auto value = cell_keys[cell];
+    const auto mask = static_cast<std::uint64_t>(table_capacity - 1);
+    for (auto slot = VoxelGridView::hash(value) & mask;;
+         slot = (slot + 1) & mask) {
+      if (claim(&table_keys[slot], value)) {
+        table_cells[slot] = cell;
+        return;
+      }
+    }
+  }
+};
+
+// Builds the grid for a frame by sorting point indices on voxel key. Every
+// stage is a parallel primitive in the execution space of the policy, and
+// the storage is borrowed from the scratch allocator, so building a grid
+// each frame doesn't allocate once the allocator has warmed up.
+template <typename Allocator> class VoxelGrid {
+public:
+  template <typename ExecutionPolicy, typename Iterator>
+  VoxelGrid(const ExecutionPolicy &policy, Allocator &allocator,
+            Iterator begin, Iterator end, float voxel_size)
+      : _point_count(thrust::distance(begin, end)), _voxel_size(voxel_size),
+        _keys(allocator, _point_count), _sorted_indices(allocator, _point_count),
+        _sorted_positions(allocator, _point_count),
+        _cell_keys(allocator, _point_count),
+        _cell_starts(allocator, _point_count + 1),
+        _table_capacity(table_capacity_for(_point_count)),
+        _table_keys(allocator, _table_capacity),
+        _table_cells(allocator, _table_capacity) {
+
+    auto keys = _keys.data();
+    auto sorted_indices = _sorted_indices.data();
+
+    thrust::transform(policy, begin, end, keys, voxel_key_of{voxel_size});
+    thrust::sequence(policy, sorted_indices, sorted_indices + _point_count);
+    thrust::sort_by_key(policy, keys, keys + _point_count, sorted_indices);
+
+    // positions are gathered into sorted order for locality during queries
+    auto positions = thrust::make_transform_iterator(begin, get_position{});
+    thrust::gather(policy, sorted_indices, sorted_indices + _point_count,
+                   positions, _sorted_positions.data());
+
+    // each distinct key marks the start of an occupied voxel
+    auto cells_end = thrust::unique_by_key_copy(
+        policy, keys, keys + _point_count, thrust::make_counting_iterator(0),
+        _cell_keys.data(), _cell_starts.data());
+    _cell_count = cells_end.first - _cell_keys.data();
+    thrust::fill_n(policy, _cell_starts.data() + _cell_count, 1,
+                   static_cast<int>(_point_count));
+
+    thrust::fill_n(policy, _table_keys.data(), _table_capacity,
+                   VoxelGridView::empty_key);
+    thrust::for_each_n(policy, thrust::make_counting_iterator(0), _cell_count,
+                       insert_voxel_cell{_cell_keys.data(), _table_keys.data(),
+                                         _table_cells.data(),
+                                         static_cast<int>(_table_capacity)});
+  }
+
+  VoxelGridView view() const {
+    return {_voxel_size,
+            static_cast<int>(_point_count),
+            static_cast<int>(_cell_count),
+            _keys.data(),
+            _cell_keys.data(),
+            _cell_starts.data(),
+            _sorted_indices.data(),
+            _sorted_positions.data(),
+            static_cast<int>(_table_capacity),
+            _table_keys.data(),
+            _table_cells.data()};
+  }
+
+  std::size_t point_count() const { return _point_count; }
+  std::size_t cell_count() const { return _cell_count; }
+  float voxel_size() const { return _voxel_size; }
+
+private:
+  std::size_t _point_count;
+  std::size_t _cell_count = 0;
+  float _voxel_size;
+  ScratchBuffer<std::uint64_t, Allocator> _keys;
+  ScratchBuffer<int, Allocator> _sorted_indices;
+  ScratchBuffer<position, Allocator> _sorted_positions;
+  ScratchBuffer<std::uint64_t, Allocator> _cell_keys;
+  ScratchBuffer<int, Allocator> _cell_starts;
+  std::size_t _table_capacity;
+  ScratchBuffer<std::uint64_t, Allocator> _table_keys;
+  ScratchBuffer<int, Allocator> _table_cells;
+
+  // there are at most as many cells as points, and keeping the table at most
+  // half full keeps probe sequences short
+  static std::size_t table_capacity_for(std::size_t point_count) {
+    std::size_t capacity = 2;
+    while (capacity < point_count * 2) capacity *= 2;
+    return capacity;
+  }
+};
+
+// Holds the voxel grid for the points currently flowing through an operator
+// chain, so consecutive spatial operators share one build. Operators that
+// move, add or remove points must call invalidate() so the next spatial
+// operator rebuilds it.
+template <typename Allocator> class VoxelGridCache {
+public:
+  explicit VoxelGridCache(Allocator &allocator) : _allocator(allocator) {}
+
+  template <typename ExecutionPolicy, typename Iterator>
+  const VoxelGrid<Allocator> &get(const ExecutionPolicy &policy,
+                                  Iterator begin, Iterator end,
+                                  float voxel_size) {
+    const std::size_t point_count = thrust::distance(begin, end);
+    if (_grid.has_value() && _grid->voxel_size() == voxel_size &&
+        _grid->point_count() == point_count) {
+      return *_grid;
+    }
+    ZoneScopedN("VoxelGrid build");
+    _grid.reset();
+    const auto start_time = std::chrono::steady_clock::now();
+    _grid.emplace(policy, _allocator, begin, end, voxel_size);
+    const std::chrono::duration<double, std::milli> build_time =
+        std::chrono::steady_clock::now() - start_time;
+    TracyPlot("Voxel grid build ms", build_time.count());
+    TracyPlot("Voxel grid points", static_cast<int64_t>(point_count));
+    TracyPlot("Voxel grid cells", static_cast<int64_t>(_grid->cell_count()));
+    return *_grid;
+  }
+
+  void invalidate() { _grid.reset(); }
+
+  Allocator &allocator() const { return _allocator; }
+
+private:
+  Allocator &_allocator;
+  std::optional<VoxelGrid<Allocator>> _grid;
+};
+
+} // namespace pc::operators
@@ -18,9 +18,27 @@ using namespace Magnum;
 using namespace Shaders;
 using namespace Math::Literals;
 
+namespace {
+
+// fills buffer with front followed by back, without joining them on the host
+template <typename T>
+void upload(GL::Buffer &buffer, const std::vector<T> &front,
+	    const std::vector<T> &back) {
+  const auto front_bytes = front.size() * sizeof(T);
+  const auto back_bytes = back.size() * sizeof(T);
+  if (back.empty()) {
+    buffer.setData({front.data(), front_bytes});
+    return;
+  }
+  buffer.setData({nullptr, front_bytes + back_bytes});
+  if (!front.empty()) buffer.setSubData(0, {front.data(), front_bytes});
+  buffer.setSubData(front_bytes, {back.data(), back_bytes});
+}
+
+} // namespace
+
 PointCloudRenderer::PointCloudRenderer()
     : _meshParticles(GL::MeshPrimitive::Points) {
-  points = pc::types::PointCloud{};
   _meshParticles.addVertexBuffer(
       _positions_buffer, 0,
       Generic3D::Position{Generic3D::Position::Components::Two,
@@ -33,18 +51,15 @@ PointCloudRenderer::PointCloudRenderer()
 PointCloudRenderer &
 PointCloudRenderer::draw(Magnum::SceneGraph::Camera3D& camera,
 		    const PointCloudRendererConfiguration &frame_config) {
-  if (points.empty()) return *this;
+  static const pc::types::PointCloud no_points;
+  const auto &frame_points = points ? *points : no_points;
+  const auto point_count = frame_points.size() + extra_points.size();
+  if (point_count == 0) return *this;
 
   if (_dirty) {
-    Containers::ArrayView<const int64_t> position_data(
-	reinterpret_cast<const int64_t *>(&points.positions[0]), points.size());
-    _positions_buffer.setData(position_data);
-
-    Containers::ArrayView<const float> color_data(
-	reinterpret_cast<const float *>(&points.colors[0]), points.size());
-    _color_buffer.setData(color_data);
-
-    _meshParticles.setCount(static_cast<int>(points.size()));
+    upload(_positions_buffer, frame_points.positions, extra_points.positions);
+    upload(_color_buffer, frame_points.colors, extra_points.colors);
+    _meshParticles.setCount(static_cast<int>(point_count));
     _dirty = false;
   }
 
@@ -33,7 +33,12 @@ namespace pc {
       return *this;
     }
 
-    pc::types::PointCloud points;
+    // the renderer holds a reference to the cloud it draws rather than a
+    // copy, so a published frame is uploaded straight from its own buffers
+    std::shared_ptr<const pc::types::PointCloud> points;
+
+    // drawn after points, e.g. snapshots
+    pc::types::PointCloud extra_points;
 
   private:
     bool _dirty = false;
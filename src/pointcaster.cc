@@ -67,6 +67,7 @@
 #include "camera/camera_controller.h"
 #include "client_sync/sync_server.h"
 #include "devices/device.h"
+#include "devices/frame_bus.h"
 #include "devices/usb.h"
 #include "gui/widgets.h"
 #include "modes.h"
@@ -82,8 +83,14 @@
 #include "wireframe_objects.h"
 
 // TODO these need to be removed when initialisation loop is made generic
+#if WITH_K4A
 #include "devices/k4a/k4a_device.h"
 #include <k4a/k4a.h>
+#endif
+
+#include "devices/replay/recording.h"
+#include "devices/replay/replay_device.h"
+#include "devices/synthetic/synthetic_device.h"
 
 #include "mqtt/mqtt_client.h"
 #include "mqtt/mqtt_client_config.gen.h"
@@ -114,7 +121,11 @@ using namespace Magnum;
 using namespace Math::Literals;
 
 using pc::devices::Device;
+#if WITH_K4A
 using pc::devices::K4ADevice;
+#endif
+using pc::devices::ReplayDevice;
+using pc::devices::SyntheticDevice;
 
 using uint = unsigned int;
 
@@ -177,6 +188,8 @@ protected:
   std::unique_ptr<WireframeGrid> _ground_grid;
 
   std::unique_ptr<SessionOperatorHost> _session_operator_host;
+  std::unique_ptr<FrameBus> _frame_bus;
+  std::uint64_t _rendered_frame_sequence = 0;
 
   std::unique_ptr<Snapshots> _snapshots_context;
 
@@ -213,6 +226,7 @@ protected:
   std::atomic_bool loading_device = false;
   void load_device(const DeviceConfiguration& config, std::string_view target_id = "");
   void open_kinect_sensors();
+  void open_recordings();
 
   void render_cameras();
   void publish_parameters();
@@ -484,7 +498,9 @@ PointCaster::PointCaster(const Arguments &args)
   if (!_session.radio.has_value()) {
     _session.radio = RadioConfiguration {};
   }
-  _radio = std::make_unique<Radio>(*_session.radio, *_session_operator_host);
+  _frame_bus = std::make_unique<FrameBus>(*_session_operator_host);
+
+  _radio = std::make_unique<Radio>(*_session.radio, *_frame_bus);
 
   if (!_session.mqtt.has_value()) {
     _session.mqtt = MqttClientConfiguration{};
@@ -511,7 +527,7 @@ PointCaster::PointCaster(const Arguments &args)
   }
   _sync_server = std::make_unique<SyncServer>(*_session.sync_server);
 
-  _snapshots_context = std::make_unique<Snapshots>();
+  _snapshots_context = std::make_unique<Snapshots>(*_frame_bus);
 
   TweenManager::create();
   _timeline.start();
@@ -551,6 +567,8 @@ inline PointCaster &CameraDisplayWindow::application() {
 }
 
 void PointCaster::quit() {
+  _radio.reset();
+  _frame_bus.reset();
   Device::attached_devices.clear();
   exit(0);
 }
@@ -716,7 +734,10 @@ void PointCaster::load_session(std::filesystem::path file_path) {
 
 void PointCaster::render_cameras() {
 
-  PointCloud points;
+  // every camera renders the same frame, and the renderer only needs
+  // updating when the frame bus has published a new one
+  auto frame = _frame_bus->latest();
+  bool points_updated = false;
 
   auto skeletons = devices::scene_skeletons();
 
@@ -735,14 +756,18 @@ void PointCaster::render_cameras() {
     // TODO: pass selected physical cameras into the
     // synthesise_point_cloud function 
     // - make sure to cache already synthesised configurations
-    if (points.empty()) {
-
-      points = devices::synthesized_point_cloud({*_session_operator_host});
-
+    if (frame && !points_updated &&
+        frame->sequence != _rendered_frame_sequence) {
+      // share the frame's points with the renderer instead of copying them
+      _point_cloud_renderer->points =
+	  std::shared_ptr<const pc::types::PointCloud>(frame,
+						       &frame->point_cloud);
       if (rendering_config.snapshots)
-        points += snapshots::point_cloud();
-      _point_cloud_renderer->points = points;
+        _point_cloud_renderer->extra_points = snapshots::point_cloud();
+      else _point_cloud_renderer->extra_points = {};
       _point_cloud_renderer->setDirty();
+      _rendered_frame_sequence = frame->sequence;
+      points_updated = true;
     }
 
     // enable or disable wireframe ground depending on camera settings
@@ -789,10 +814,26 @@ void PointCaster::render_cameras() {
 void PointCaster::load_device(const DeviceConfiguration& config, std::string_view target_id) {
   loading_device = true;
   try {
-    auto device = std::make_shared<K4ADevice>(config, target_id);
+    std::shared_ptr<Device> device;
+    if (!config.replay.file_path.empty()) {
+      device = std::make_shared<ReplayDevice>(config);
+    } else if (config.synthetic.enabled) {
+      device = std::make_shared<SyntheticDevice>(config, target_id);
+    } else {
+#if WITH_K4A
+      device = std::make_shared<K4ADevice>(config, target_id);
+#else
+      pc::logger->error("Can't open a K4A device, this build has no K4A "
+                        "support");
+      loading_device = false;
+      return;
+#endif
+    }
     Device::attached_devices.push_back(device);
+#if WITH_K4A
   } catch (k4a::error e) {
     pc::logger->error(e.what());
+#endif
   } catch (...) {
     pc::logger->error("Failed to open device. (Unknown exception)");
   }
@@ -800,9 +841,10 @@ void PointCaster::load_device(const DeviceConfiguration& config, std::string_vie
 }
 
 void PointCaster::open_kinect_sensors() {
+#if WITH_K4A
   run_async([this] {
     loading_device = true;
-    const auto open_device_count = Device::attached_devices.size();
+    const auto open_device_count = K4ADevice::count.load();
     const auto attached_device_count = k4a::device::get_installed_count();
     pc::logger->info("Found {} attached k4a devices", (int)attached_device_count);
     for (std::size_t i = open_device_count; i < attached_device_count; i++) {
@@ -810,6 +852,32 @@ void PointCaster::open_kinect_sensors() {
     }
     loading_device = false;
   });
+#endif
+}
+
+void PointCaster::open_recordings() {
+  run_async([this] {
+    const auto recordings_dir =
+        path::get_or_create_data_directory() / "recordings";
+    if (!std::filesystem::exists(recordings_dir)) {
+      pc::logger->info("No recordings found in {}", recordings_dir.string());
+      return;
+    }
+    for (const auto &entry :
+         std::filesystem::directory_iterator(recordings_dir)) {
+      if (entry.path().extension() != devices::replay::recording_extension)
+        continue;
+      const auto already_open = std::any_of(
+          Device::attached_devices.begin(), Device::attached_devices.end(),
+          [&](auto &device) {
+            return device->config().replay.file_path == entry.path().string();
+          });
+      if (already_open) continue;
+      DeviceConfiguration config{};
+      config.replay.file_path = entry.path().string();
+      load_device(config);
+    }
+  });
 }
 
 void PointCaster::draw_menu_bar() {
@@ -1282,6 +1350,22 @@ void PointCaster::draw_devices_window() {
     ImGui::SameLine();
     ImGui::Dummy({4, 0});
     ImGui::SameLine();
+    if (ImGui::Button("Replay")) {
+      open_recordings();
+    }
+    ImGui::SameLine();
+    ImGui::Dummy({4, 0});
+    ImGui::SameLine();
+    if (ImGui::Button("Synthetic")) {
+      run_async([this] {
+        DeviceConfiguration config{};
+        config.synthetic.enabled = true;
+        load_device(config);
+      });
+    }
+    ImGui::SameLine();
+    ImGui::Dummy({4, 0});
+    ImGui::SameLine();
     if (ImGui::Button("Close")) {
       Device::attached_devices.clear();
     }
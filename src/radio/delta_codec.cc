@@ -0,0 +1,292 @@
+#include "delta_codec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace pc::radio {
+
+using bob::types::PointCloud;
+
+std::uint64_t VoxelFrame::key(const bob::types::position &position,
+                              float voxel_size) {
+  // positions are shorts, so the voxel coordinates fit in 17 bits each
+  constexpr int key_bits = 21;
+  constexpr int key_offset = 1 << (key_bits - 1);
+  const auto x = static_cast<int>(std::floor(position.x / voxel_size));
+  const auto y = static_cast<int>(std::floor(position.y / voxel_size));
+  const auto z = static_cast<int>(std::floor(position.z / voxel_size));
+  return (std::uint64_t(z + key_offset) << (2 * key_bits)) |
+         (std::uint64_t(y + key_offset) << key_bits) |
+         std::uint64_t(x + key_offset);
+}
+
+void VoxelFrame::bucket(const PointCloud &cloud, float voxel_size) {
+  this->voxel_size = voxel_size;
+  const auto point_count = cloud.size();
+
+  thread_local std::vector<std::pair<std::uint64_t, std::uint32_t>> order;
+  order.resize(point_count);
+  for (std::size_t i = 0; i < point_count; i++) {
+    order[i] = {key(cloud.positions[i], voxel_size),
+                static_cast<std::uint32_t>(i)};
+  }
+  std::sort(order.begin(), order.end());
+
+  keys.clear();
+  starts.clear();
+  summaries.clear();
+  points.positions.resize(point_count);
+  points.colors.resize(point_count);
+
+  for (std::size_t slot = 0; slot < point_count; slot++) {
+    const auto [voxel_key, index] = order[slot];
+    if (keys.empty() || keys.back() != voxel_key) {
+      keys.push_back(voxel_key);
+      starts.push_back(static_cast<std::uint32_t>(slot));
+    }
+    points.positions[slot] = cloud.positions[index];
+    points.colors[slot] = cloud.colors[index];
+  }
+  starts.push_back(static_cast<std::uint32_t>(point_count));
+
+  summaries.resize(keys.size());
+  for (std::size_t voxel = 0; voxel < keys.size(); voxel++) {
+    VoxelSummary summary{starts[voxel + 1] - starts[voxel], 0, 0, 0, 0, 0, 0};
+    for (auto slot = starts[voxel]; slot < starts[voxel + 1]; slot++) {
+      const auto &p = points.positions[slot];
+      const auto &c = points.colors[slot];
+      summary.x += p.x;
+      summary.y += p.y;
+      summary.z += p.z;
+      summary.r += c.r;
+      summary.g += c.g;
+      summary.b += c.b;
+    }
+    const float count = static_cast<float>(summary.point_count);
+    summary.x /= count;
+    summary.y /= count;
+    summary.z /= count;
+    summary.r /= count;
+    summary.g /= count;
+    summary.b /= count;
+    summaries[voxel] = summary;
+  }
+}
+
+static bool voxel_changed(const VoxelSummary &sent,
+                          const VoxelSummary &current,
+                          const DeltaThresholds &thresholds) {
+  // a quarter of the points appearing or disappearing is a change whether
+  // or not the average moves
+  const auto count_change = std::abs(static_cast<int>(current.point_count) -
+                                     static_cast<int>(sent.point_count));
+  if (count_change * 4 >
+      static_cast<int>(std::max(current.point_count, sent.point_count))) {
+    return true;
+  }
+  const float dx = current.x - sent.x;
+  const float dy = current.y - sent.y;
+  const float dz = current.z - sent.z;
+  const float position_threshold = thresholds.position;
+  if (dx * dx + dy * dy + dz * dz > position_threshold * position_threshold) {
+    return true;
+  }
+  return std::abs(current.r - sent.r) > thresholds.color ||
+         std::abs(current.g - sent.g) > thresholds.color ||
+         std::abs(current.b - sent.b) > thresholds.color;
+}
+
+bob::types::bytes DeltaEncoder::encode(const VoxelFrame &frame, bool keyframe,
+                                       const DeltaThresholds &thresholds,
+                                       bool compress,
+                                       std::size_t reserved_bytes) {
+  if (keyframe) {
+    _sent_keys.clear();
+    _sent_summaries.clear();
+  }
+  _voxel_size = frame.voxel_size;
+
+  _next_keys.clear();
+  _next_summaries.clear();
+  _removed_keys.clear();
+  _updated_keys.clear();
+  _updated_counts.clear();
+  _updated_points.positions.clear();
+  _updated_points.colors.clear();
+
+  const auto update = [&](std::size_t voxel) {
+    const auto first = frame.starts[voxel];
+    const auto last = frame.starts[voxel + 1];
+    _updated_keys.push_back(frame.keys[voxel]);
+    _updated_counts.push_back(last - first);
+    _updated_points.positions.insert(_updated_points.positions.end(),
+                                     frame.points.positions.begin() + first,
+                                     frame.points.positions.begin() + last);
+    _updated_points.colors.insert(_updated_points.colors.end(),
+                                  frame.points.colors.begin() + first,
+                                  frame.points.colors.begin() + last);
+    _next_keys.push_back(frame.keys[voxel]);
+    _next_summaries.push_back(frame.summaries[voxel]);
+  };
+
+  // both key lists are sorted, so one walk over them finds every voxel
+  // that was added, removed or changed
+  std::size_t sent = 0;
+  std::size_t voxel = 0;
+  while (sent < _sent_keys.size() || voxel < frame.keys.size()) {
+    if (voxel == frame.keys.size() ||
+        (sent < _sent_keys.size() && _sent_keys[sent] < frame.keys[voxel])) {
+      _removed_keys.push_back(_sent_keys[sent++]);
+    } else if (sent == _sent_keys.size() ||
+               frame.keys[voxel] < _sent_keys[sent]) {
+      update(voxel++);
+    } else {
+      if (voxel_changed(_sent_summaries[sent], frame.summaries[voxel],
+                        thresholds)) {
+        update(voxel);
+      } else {
+        _next_keys.push_back(_sent_keys[sent]);
+        _next_summaries.push_back(_sent_summaries[sent]);
+      }
+      sent++;
+      voxel++;
+    }
+  }
+  std::swap(_sent_keys, _next_keys);
+  std::swap(_sent_summaries, _next_summaries);
+
+  bob::types::bytes cloud_bytes;
+  if (_updated_points.size() > 0) {
+    cloud_bytes = _updated_points.serialize(compress);
+  }
+
+  const DeltaPayloadHeader header{
+      _voxel_size, static_cast<std::uint32_t>(_removed_keys.size()),
+      static_cast<std::uint32_t>(_updated_keys.size())};
+  const auto removed_size = _removed_keys.size() * sizeof(std::uint64_t);
+  const auto updated_size = _updated_keys.size() * sizeof(std::uint64_t);
+  const auto counts_size = _updated_counts.size() * sizeof(std::uint32_t);
+
+  bob::types::bytes result(reserved_bytes + sizeof(header) + removed_size +
+                           updated_size + counts_size + cloud_bytes.size());
+  auto output = result.data() + reserved_bytes;
+  std::memcpy(output, &header, sizeof(header));
+  output += sizeof(header);
+  std::memcpy(output, _removed_keys.data(), removed_size);
+  output += removed_size;
+  std::memcpy(output, _updated_keys.data(), updated_size);
+  output += updated_size;
+  std::memcpy(output, _updated_counts.data(), counts_size);
+  output += counts_size;
+  std::memcpy(output, cloud_bytes.data(), cloud_bytes.size());
+  return result;
+}
+
+bool DeltaDecoder::decode(const std::byte *data, std::size_t size,
+                          bool keyframe) {
+  if (!keyframe && !_valid) return false;
+  // anything applied after a malformed frame would be based on the wrong
+  // voxels, so wait for a keyframe
+  _valid = false;
+
+  DeltaPayloadHeader header;
+  if (size < sizeof(header)) return false;
+  std::memcpy(&header, data, sizeof(header));
+  data += sizeof(header);
+  size -= sizeof(header);
+
+  const auto removed_size = header.removed_count * sizeof(std::uint64_t);
+  const auto updated_size = header.updated_count * sizeof(std::uint64_t);
+  const auto counts_size = header.updated_count * sizeof(std::uint32_t);
+  if (size < removed_size + updated_size + counts_size) return false;
+
+  thread_local std::vector<std::uint64_t> removed_keys;
+  thread_local std::vector<std::uint64_t> updated_keys;
+  thread_local std::vector<std::uint32_t> updated_counts;
+  removed_keys.resize(header.removed_count);
+  updated_keys.resize(header.updated_count);
+  updated_counts.resize(header.updated_count);
+  std::memcpy(removed_keys.data(), data, removed_size);
+  data += removed_size;
+  std::memcpy(updated_keys.data(), data, updated_size);
+  data += updated_size;
+  std::memcpy(updated_counts.data(), data, counts_size);
+  data += counts_size;
+  size -= removed_size + updated_size + counts_size;
+
+  PointCloud updated_points;
+  if (size > 0) {
+    bob::types::bytes cloud_bytes(data, data + size);
+    updated_points = PointCloud::deserialize(cloud_bytes);
+  }
+  std::size_t updated_point_count = 0;
+  for (auto count : updated_counts) updated_point_count += count;
+  if (updated_point_count != updated_points.size()) return false;
+
+  if (keyframe) {
+    _frame.keys.clear();
+    _frame.starts.assign(1, 0);
+    _frame.points.positions.clear();
+    _frame.points.colors.clear();
+  }
+
+  _next.voxel_size = header.voxel_size;
+  _next.keys.clear();
+  _next.starts.clear();
+  _next.points.positions.clear();
+  _next.points.colors.clear();
+
+  const auto append = [&](std::uint64_t key, const PointCloud &source,
+                           std::size_t first, std::size_t last) {
+    _next.keys.push_back(key);
+    _next.starts.push_back(static_cast<std::uint32_t>(_next.points.size()));
+    _next.points.positions.insert(_next.points.positions.end(),
+                                  source.positions.begin() + first,
+                                  source.positions.begin() + last);
+    _next.points.colors.insert(_next.points.colors.end(),
+                               source.colors.begin() + first,
+                               source.colors.begin() + last);
+  };
+
+  // the previous frame's voxels, removed voxels and updated voxels are all
+  // in key order, so they merge in one walk
+  const auto &previous = _frame;
+  std::size_t voxel = 0;
+  std::size_t removed = 0;
+  std::size_t updated = 0;
+  std::size_t updated_offset = 0;
+  while (voxel < previous.keys.size() || updated < updated_keys.size()) {
+    if (updated < updated_keys.size() &&
+        (voxel == previous.keys.size() ||
+         updated_keys[updated] <= previous.keys[voxel])) {
+      if (voxel < previous.keys.size() &&
+          previous.keys[voxel] == updated_keys[updated]) {
+        voxel++;
+      }
+      const auto count = updated_counts[updated];
+      append(updated_keys[updated], updated_points, updated_offset,
+             updated_offset + count);
+      updated_offset += count;
+      updated++;
+    } else {
+      const auto key = previous.keys[voxel];
+      while (removed < removed_keys.size() && removed_keys[removed] < key) {
+        removed++;
+      }
+      if (removed == removed_keys.size() || removed_keys[removed] != key) {
+        append(key, previous.points, previous.starts[voxel],
+               previous.starts[voxel + 1]);
+      }
+      voxel++;
+    }
+  }
+  _next.starts.push_back(static_cast<std::uint32_t>(_next.points.size()));
+
+  std::swap(_frame, _next);
+  _valid = true;
+  return true;
+}
+
+} // namespace pc::radio
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <pointclouds.h>
+#include <vector>
+
+// Shared with the pointreceiver library, so this only depends on the
+// standard library and bob-pointclouds.
+
+namespace pc::radio {
+
+// The average of the points in one voxel
+struct VoxelSummary {
+  std::uint32_t point_count;
+  float x, y, z;
+  float r, g, b;
+};
+
+// A point cloud bucketed into cubic voxels, with its points sorted by voxel
+// so that each occupied voxel owns a contiguous range of them.
+struct VoxelFrame {
+  float voxel_size = 0;
+  // keys of the occupied voxels in ascending order
+  std::vector<std::uint64_t> keys;
+  // first point of each voxel, with starts[keys.size()] == points.size()
+  std::vector<std::uint32_t> starts;
+  // only filled in by bucket()
+  std::vector<VoxelSummary> summaries;
+  bob::types::PointCloud points;
+
+  static std::uint64_t key(const bob::types::position &position,
+                           float voxel_size);
+
+  // replaces the contents with cloud, reusing existing capacity
+  void bucket(const bob::types::PointCloud &cloud, float voxel_size);
+};
+
+// How far a voxel's average may drift from what a receiver last saw before
+// the voxel is sent again
+struct DeltaThresholds {
+  // in mm
+  float position = 5;
+  // in colour channel steps
+  float color = 12;
+};
+
+// Leads every keyframe and delta, followed by the keys of the removed
+// voxels, the keys of the updated voxels, the point count of each updated
+// voxel, and finally the serialized points of the updated voxels in order.
+struct DeltaPayloadHeader {
+  float voxel_size;
+  std::uint32_t removed_count;
+  std::uint32_t updated_count;
+  std::uint32_t reserved = 0;
+};
+
+// Encodes a stream of voxel frames as keyframes, which carry every voxel,
+// and deltas, which only carry the voxels that appeared, disappeared or
+// changed since the previous encode(). Changes are measured against what
+// the receiver was last sent rather than the previous frame, so slow drift
+// still gets sent once it adds up.
+//
+// Not thread-safe, and frames must be sent in the order they're encoded.
+class DeltaEncoder {
+public:
+  // a delta can't be encoded against a different voxel size, so the caller
+  // has to ask for a keyframe instead
+  bool needs_keyframe(const VoxelFrame &frame) const {
+    return frame.voxel_size != _voxel_size;
+  }
+
+  // returns the encoded frame preceded by reserved_bytes of space for the
+  // caller to fill in
+  bob::types::bytes encode(const VoxelFrame &frame, bool keyframe,
+                           const DeltaThresholds &thresholds, bool compress,
+                           std::size_t reserved_bytes = 0);
+
+  std::size_t updated_voxel_count() const { return _updated_keys.size(); }
+  std::size_t removed_voxel_count() const { return _removed_keys.size(); }
+
+private:
+  float _voxel_size = 0;
+  // what the receiver has, in key order
+  std::vector<std::uint64_t> _sent_keys;
+  std::vector<VoxelSummary> _sent_summaries;
+
+  // reused from frame to frame
+  std::vector<std::uint64_t> _next_keys;
+  std::vector<VoxelSummary> _next_summaries;
+  std::vector<std::uint64_t> _removed_keys;
+  std::vector<std::uint64_t> _updated_keys;
+  std::vector<std::uint32_t> _updated_counts;
+  bob::types::PointCloud _updated_points;
+};
+
+// Rebuilds full frames from the output of a DeltaEncoder.
+class DeltaDecoder {
+public:
+  // applies a keyframe, or a delta on top of the last decoded frame.
+  // returns false and leaves the frame unchanged if the data is malformed,
+  // or if it's a delta and there's no valid frame to apply it to.
+  bool decode(const std::byte *data, std::size_t size, bool keyframe);
+
+  // call when a frame has gone missing, so that deltas are ignored until
+  // the next keyframe
+  void invalidate() { _valid = false; }
+
+  const bob::types::PointCloud &point_cloud() const { return _frame.points; }
+
+private:
+  bool _valid = false;
+  VoxelFrame _frame;
+  VoxelFrame _next;
+};
+
+} // namespace pc::radio
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Shared with the pointreceiver library, so this header only depends on the
+// standard library.
+
+namespace pc::radio {
+
+// what follows the header
+enum class FrameEncoding : std::uint32_t {
+  // a complete serialized point cloud
+  PointCloud = 0,
+  // a DeltaEncoder keyframe, which resets the receiver's frame
+  Keyframe = 1,
+  // a DeltaEncoder delta against the previous frame
+  Delta = 2
+};
+
+// the most levels of detail a frame is split into
+inline constexpr int max_lod_levels = 6;
+
+// Prefixes every live frame the radio broadcasts. Receivers use the
+// sequence to detect dropped frames and the timestamps to measure latency,
+// so the timestamps are wall clock time in microseconds since the unix
+// epoch, and only comparable between machines as far as their clocks are
+// synchronised.
+struct FrameHeader {
+  static constexpr std::uint32_t magic = 0x48464350; // "PCFH"
+  static constexpr std::uint32_t current_version = 3;
+
+  std::uint32_t magic_number = magic;
+  std::uint32_t version = current_version;
+  // increases by one with every frame the radio sends. every level of
+  // detail of a frame shares its sequence.
+  std::uint64_t sequence = 0;
+  // when the oldest sensor frame merged into this frame was captured
+  std::int64_t capture_time_us = 0;
+  // when the radio handed the frame to the network
+  std::int64_t send_time_us = 0;
+  FrameEncoding encoding = FrameEncoding::PointCloud;
+  // frames split into levels of detail are sent as one message per level,
+  // coarsest first. frames on the plain live group are one level.
+  std::uint16_t level = 0;
+  std::uint16_t level_count = 1;
+};
+
+static_assert(sizeof(FrameHeader) == 40);
+
+inline void write_frame_header(const FrameHeader &header, std::byte *data) {
+  std::memcpy(data, &header, sizeof(FrameHeader));
+}
+
+// returns false if the message is too short or doesn't start with a header
+inline bool read_frame_header(const std::byte *data, std::size_t size,
+                              FrameHeader &header) {
+  if (size < sizeof(FrameHeader)) return false;
+  std::memcpy(&header, data, sizeof(FrameHeader));
+  return header.magic_number == FrameHeader::magic &&
+         header.version == FrameHeader::current_version;
+}
+
+} // namespace pc::radio
@@ -0,0 +1,87 @@
+#include "octree_lod.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <tracy/Tracy.hpp>
+#include <utility>
+
+namespace pc::radio {
+
+// spreads the low 16 bits of v out to every third bit
+static std::uint64_t spread_bits(std::uint64_t v) {
+  v &= 0xffff;
+  v = (v | v << 16) & 0x0000ff0000ff;
+  v = (v | v << 8) & 0x00f00f00f00f;
+  v = (v | v << 4) & 0x0c30c30c30c3;
+  v = (v | v << 2) & 0x249249249249;
+  return v;
+}
+
+// Interleaving the bits of the coordinates puts every octree cell in one
+// contiguous range of sorted codes, and the code of a cell with sides of
+// 2^b mm is the point's code shifted right by 3b.
+static std::uint64_t morton_code(const pc::types::position &p) {
+  // offset the signed coordinates so that they sort in order
+  constexpr int offset = 1 << 15;
+  return spread_bits(p.x + offset) | (spread_bits(p.y + offset) << 1) |
+         (spread_bits(p.z + offset) << 2);
+}
+
+void split_lod_levels(const pc::types::PointCloud &cloud,
+                      float coarsest_cell_size, int level_count,
+                      std::vector<pc::types::PointCloud> &levels) {
+  ZoneScopedN("split_lod_levels");
+
+  level_count = std::max(level_count, 1);
+  levels.resize(level_count);
+  for (auto &level : levels) {
+    level.positions.clear();
+    level.colors.clear();
+  }
+
+  const auto point_count = cloud.size();
+  thread_local std::vector<std::pair<std::uint64_t, std::uint32_t>> order;
+  thread_local std::vector<int> point_levels;
+  order.resize(point_count);
+  for (std::size_t i = 0; i < point_count; i++) {
+    order[i] = {morton_code(cloud.positions[i]),
+                static_cast<std::uint32_t>(i)};
+  }
+  std::sort(order.begin(), order.end());
+
+  // every level but the last is one point per cell, the rest go last
+  point_levels.assign(point_count, level_count - 1);
+
+  const int coarsest_bits =
+      std::clamp(static_cast<int>(std::lround(std::log2(coarsest_cell_size))),
+                 level_count - 1, 16);
+
+  for (int level = 0; level < level_count - 1; level++) {
+    const int shift = 3 * (coarsest_bits - level);
+    std::size_t cell_start = 0;
+    while (cell_start < point_count) {
+      const auto cell = order[cell_start].first >> shift;
+      bool represented = false;
+      auto cell_end = cell_start;
+      while (cell_end < point_count &&
+             (order[cell_end].first >> shift) == cell) {
+        represented |= point_levels[cell_end] < level;
+        cell_end++;
+      }
+      // the middle of a cell's range is nearer its centre than either end
+      if (!represented) {
+        point_levels[cell_start + (cell_end - cell_start) / 2] = level;
+      }
+      cell_start = cell_end;
+    }
+  }
+
+  for (std::size_t slot = 0; slot < point_count; slot++) {
+    auto &level = levels[point_levels[slot]];
+    const auto index = order[slot].second;
+    level.positions.push_back(cloud.positions[index]);
+    level.colors.push_back(cloud.colors[index]);
+  }
+}
+
+} // namespace pc::radio
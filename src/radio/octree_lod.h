@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../structs.h"
+#include <vector>
+
+namespace pc::radio {
+
+// Splits a cloud into progressively finer levels of detail by walking an
+// octree over it. Level 0 holds one point from each occupied cell of the
+// coarsest size, and each following level adds one point from every cell
+// half the size that isn't represented yet. The last level holds every
+// remaining point, so together the levels make up the whole cloud and a
+// receiver can stop at any level.
+//
+// The coarsest cell size in mm is rounded to a power of two so that cells
+// nest exactly. levels is resized to level_count, reusing its capacity.
+void split_lod_levels(const pc::types::PointCloud &cloud,
+                      float coarsest_cell_size, int level_count,
+                      std::vector<pc::types::PointCloud> &levels);
+
+} // namespace pc::radio
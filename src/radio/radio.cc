@@ -2,220 +2,451 @@
 #include "../devices/device.h"
 #include "../logger.h"
 #include "../snapshots.h"
+#include "octree_lod.h"
 #include <tracy/Tracy.hpp>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <fmt/format.h>
 #include <imgui.h>
 #include <map>
 #include <numeric>
+#include <string_view>
 #include <zmq.hpp>
 
 namespace pc::radio {
 
 using namespace pc::parameters;
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+struct StatSummary {
+  float average = 0;
+  float min = 0;
+  float max = 0;
+};
 
 static std::mutex stats_access;
-static std::vector<unsigned int> send_durations;
+static std::vector<float> encode_durations;
+static std::vector<float> send_durations;
+static std::vector<float> latencies;
 static std::vector<float> frame_sizes;
 
 unsigned int stats_frame_counter = 0;
-float avg_duration = 0;
-std::pair<unsigned int, unsigned int> minmax_duration;
-float avg_size = 0;
-std::pair<float, float> minmax_size;
-
-Radio::Radio(RadioConfiguration &config,
-             pc::operators::SessionOperatorHost &session_operator_host)
-    : _config(config), _session_operator_host(session_operator_host),
-      _radio_thread(std::make_unique<std::jthread>([this](std::stop_token st) {
-        using namespace std::chrono;
-        using namespace std::chrono_literals;
-
-        zmq::context_t zmq_context;
-        zmq::socket_t radio(zmq_context, zmq::socket_type::radio);
-        // prioritise the latest frame
-        radio.set(zmq::sockopt::sndhwm, 1);
-        // and don't keep excess frames in memory
-        radio.set(zmq::sockopt::linger, 0);
-
-        // auto destination = fmt::format("tcp://:{}", _config.port);
-        // auto destination = "tcp://*:9999";
-        // radio.bind(destination);
-        radio.bind("tcp://127.0.0.1:9992");
-        pc::logger->info("Radio broadcasting on port {}", _config.port);
-
-        using delta_time = duration<unsigned int, milliseconds>;
-        milliseconds delta_ms;
-
-        unsigned int broadcast_snapshot_frame_count = 0;
-
-        constexpr auto broadcast_rate = 33ms;
-        auto next_send_time = steady_clock::now() + broadcast_rate;
-
-        while (!st.stop_requested()) {
-          ZoneScopedN("Radio Tick");
-
-          if (!_config.enabled) {
-            std::this_thread::sleep_until(next_send_time);
-            next_send_time += broadcast_rate;
-            continue;
-          }
-
-          if (steady_clock::now() < next_send_time) {
-            std::this_thread::sleep_until(next_send_time);
-          }
-          next_send_time += broadcast_rate;
-
-          std::size_t packet_bytes = 0;
-          {
-            ZoneScopedN("Serialization and send");
-            auto start_send_time = steady_clock::now();
-
-            // if (snapshots::frames.size() != broadcast_snapshot_frame_count) {
-
-            //   if (snapshots::frames.size() == 0) {
-            //     zmq::message_t snapshot_frame_msg(std::string_view("clear"));
-            //     snapshot_frame_msg.set_group("snapshots");
-            //     radio.send(snapshot_frame_msg, zmq::send_flags::none);
-            //     packet_bytes += snapshot_frame_msg.size();
-            //   } else {
-            //     auto synthesized_snapshot_frame = std::reduce(
-            //         snapshots::frames.begin(), snapshots::frames.end(),
-            //         types::PointCloud{},
-            //         [](auto a, auto b) -> types::PointCloud { return a + b;
-            //         });
-            //     auto bytes = synthesized_snapshot_frame.serialize(
-            //         _config.compress_frames);
-            //     zmq::message_t snapshot_frames_msg(bytes);
-            //     snapshot_frames_msg.set_group("snapshots");
-            //     radio.send(snapshot_frames_msg, zmq::send_flags::none);
-            //     packet_bytes += snapshot_frames_msg.size();
-            //   }
-            //   broadcast_snapshot_frame_count = snapshots::frames.size();
-            // }
-
-            auto live_point_cloud = pc::devices::synthesized_point_cloud({ _session_operator_host });
-            if (live_point_cloud.size() > 0) {
-              auto bytes = live_point_cloud.serialize(_config.compress_frames);
-              zmq::message_t point_cloud_msg(bytes);
-              point_cloud_msg.set_group("live");
-              {
-		ZoneScopedN("Send");
-                radio.send(point_cloud_msg, zmq::send_flags::none);
-                packet_bytes += point_cloud_msg.size();
-              }
-            }
-
-            delta_ms = duration_cast<milliseconds>(steady_clock::now() -
-                                                   start_send_time);
-          }
-
-          if (_config.capture_stats) {
-            std::lock_guard lock(stats_access);
-            send_durations.push_back(delta_ms.count());
-            frame_sizes.push_back(packet_bytes / (float)1024);
-            constexpr auto max_stats_count = 300;
-            if (send_durations.size() > max_stats_count) {
-              send_durations.clear();
-              frame_sizes.clear();
-            }
-          }
-        }
+StatSummary encode_summary;
+StatSummary send_summary;
+StatSummary latency_summary;
+StatSummary size_summary;
+
+static StatSummary summarise(const std::vector<float> &values) {
+  if (values.empty()) return {};
+  const auto minmax = std::minmax_element(values.begin(), values.end());
+  return {std::reduce(values.begin(), values.end()) / values.size(),
+          *minmax.first, *minmax.second};
+}
+
+// splits a comma separated endpoint list, falling back to tcp on the given
+// port when the list is empty
+static std::vector<std::string> parse_endpoints(std::string_view endpoints,
+                                                int port) {
+  std::vector<std::string> result;
+  while (!endpoints.empty()) {
+    const auto separator = endpoints.find(',');
+    auto endpoint = endpoints.substr(0, separator);
+    const auto first = endpoint.find_first_not_of(" \t");
+    const auto last = endpoint.find_last_not_of(" \t");
+    if (first != std::string_view::npos) {
+      result.emplace_back(endpoint.substr(first, last - first + 1));
+    }
+    if (separator == std::string_view::npos) break;
+    endpoints.remove_prefix(separator + 1);
+  }
+  if (result.empty()) result.push_back(fmt::format("tcp://*:{}", port));
+  return result;
+}
+
+// radio sockets send udp datagrams to a dish that has bound the address,
+// so these are connected instead of bound
+static bool is_datagram_endpoint(std::string_view endpoint) {
+  return endpoint.starts_with("udp://");
+}
+
+// frame headers carry wall clock time, so that receivers on other machines
+// can compare them with their own clocks
+static std::int64_t unix_time_us(steady_clock::time_point time) {
+  const auto system_time =
+      system_clock::now() +
+      duration_cast<system_clock::duration>(time - steady_clock::now());
+  return duration_cast<microseconds>(system_time.time_since_epoch()).count();
+}
 
-        pc::logger->info("Ended radio thread");
-      })) {
+Radio::Radio(RadioConfiguration &config, pc::devices::FrameBus &frame_bus)
+    : _config(config), _frame_bus(frame_bus),
+      _requested_endpoints(config.endpoints), _requested_port(config.port),
+      _selector_thread([this](std::stop_token st) { select_frames(st); }),
+      _sender_thread([this](std::stop_token st) { send_frames(st); }) {
+  // compression is the slow part of a broadcast, but leave most cores to
+  // the devices and operators
+  const auto encoder_count =
+      std::clamp(std::thread::hardware_concurrency() / 4, 1u, 4u);
+  _encoder_threads.reserve(encoder_count);
+  for (unsigned int i = 0; i < encoder_count; i++) {
+    _encoder_threads.emplace_back(
+        [this](std::stop_token st) { encode_frames(st); });
+  }
   declare_parameters("radio", _config);
 }
 
-void Radio::draw_imgui_window() {
+void Radio::select_frames(std::stop_token st) {
+  std::uint64_t last_selected_sequence = 0;
+  auto next_select_time = steady_clock::now();
 
-  ImGui::Begin("Radio", nullptr);
-  pc::gui::draw_parameters("radio", struct_parameters.at("radio"));
-  ImGui::End();
+  while (!st.stop_requested()) {
+    if (!_config.enabled) {
+      std::this_thread::sleep_for(50ms);
+      continue;
+    }
 
-  return;
-  ImGui::PushID("Radio");
-  ImGui::SetNextWindowPos({350.0f, 200.0f}, ImGuiCond_FirstUseEver);
-  ImGui::SetNextWindowSize({200.0f, 100.0f}, ImGuiCond_FirstUseEver);
-  ImGui::SetNextWindowBgAlpha(0.8f);
+    // when the rate is capped, wait out the interval first so that we take
+    // whichever frame is newest once it's over
+    std::this_thread::sleep_until(next_select_time);
 
-  ImGui::Begin("Radio", nullptr);
-  ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.8f);
+    // the bus only publishes once a device has uploaded a new sensor
+    // frame, so any frame we haven't sent already carries new data
+    auto frame = _frame_bus.wait_for_frame(last_selected_sequence, 50ms);
+    if (!frame) continue;
+    last_selected_sequence = frame->sequence;
+    if (frame->point_cloud.size() == 0) continue;
 
-  ImGui::Checkbox("enabled", &_config.enabled);
+    const auto max_frame_rate = _config.max_frame_rate;
+    next_select_time = steady_clock::now();
+    if (max_frame_rate > 0) {
+      next_select_time += duration_cast<steady_clock::duration>(
+          duration<float>(1.0f / max_frame_rate));
+    }
 
-  ImGui::Checkbox("compress_frames", &_config.compress_frames);
+    _dropped_frames += _frames_to_encode.push(std::move(frame));
+  }
 
-  ImGui::Spacing();
-  ImGui::Separator();
-  ImGui::Spacing();
+  pc::logger->info("Ended radio selector thread");
+}
+
+void Radio::encode_frames(std::stop_token st) {
+  while (!st.stop_requested()) {
+    pc::devices::FrameRef frame;
+    if (!_frames_to_encode.pop(frame, 50ms)) continue;
+
+    ZoneScopedN("Radio::encode_frames");
+    const auto start_time = steady_clock::now();
+    EncodedFrame encoded{frame->sequence, frame->capture_timestamp};
+    if (_config.lod_levels > 1) {
+      // each level is encoded once, however many receivers join it
+      thread_local std::vector<pc::types::PointCloud> levels;
+      split_lod_levels(frame->point_cloud, _config.lod_cell_size,
+                       std::min(_config.lod_levels, max_lod_levels), levels);
+      for (const auto &level : levels) {
+        // an empty level is sent as just its header
+        auto bytes = std::make_unique<bob::types::bytes>();
+        if (level.size() > 0) *bytes = level.serialize(_config.compress_frames);
+        bytes->insert(bytes->begin(), sizeof(FrameHeader), std::byte{0});
+        encoded.levels.push_back(std::move(bytes));
+      }
+    } else if (_config.encoding == 1) {
+      // deltas depend on the frame sent before them, so only the bucketing
+      // can happen here. the sender encodes the difference.
+      encoded.voxels = std::make_unique<VoxelFrame>();
+      encoded.voxels->bucket(frame->point_cloud,
+                             std::max(_config.delta_voxel_size, 1.0f));
+    } else {
+      encoded.bytes = std::make_unique<bob::types::bytes>(
+          frame->point_cloud.serialize(_config.compress_frames));
+      // leave room for the header, which the sender fills in
+      encoded.bytes->insert(encoded.bytes->begin(), sizeof(FrameHeader),
+                            std::byte{0});
+    }
+    encoded.encode_ms =
+        duration<float, std::milli>(steady_clock::now() - start_time).count();
+    // let the bus reuse the frame
+    frame.reset();
+
+    TracyPlot("Radio encode ms", encoded.encode_ms);
+    _dropped_frames += _frames_to_send.push(std::move(encoded));
+  }
+
+  pc::logger->info("Ended radio encoder thread");
+}
 
-  ImGui::Checkbox("Capture Stats", &_config.capture_stats);
+void Radio::send_frames(std::stop_token st) {
+  zmq::context_t zmq_context;
+  zmq::socket_t radio(zmq_context, zmq::socket_type::radio);
+  // don't keep excess frames in memory
+  radio.set(zmq::sockopt::linger, 0);
+
+  // the endpoints the socket is currently attached to. bound endpoints are
+  // stored as resolved by zeromq, since a wildcard address can't be unbound.
+  std::vector<std::string> active_endpoints;
+  std::string applied_endpoints;
+  int applied_port = -1;
+  int applied_level_count = 0;
+
+  // receivers can only pick up a delta-encoded stream from a keyframe
+  DeltaEncoder delta_encoder;
+  bool request_keyframe = true;
+  int frames_since_keyframe = 0;
+
+  const auto apply_endpoints = [&](int level_count) {
+    std::string endpoints;
+    int port;
+    {
+      std::lock_guard lock(_endpoints_access);
+      if (_requested_endpoints == applied_endpoints &&
+          _requested_port == applied_port &&
+          level_count == applied_level_count) {
+        return;
+      }
+      endpoints = _requested_endpoints;
+      port = _requested_port;
+    }
+    for (const auto &endpoint : active_endpoints) {
+      try {
+        if (is_datagram_endpoint(endpoint)) radio.disconnect(endpoint);
+        else radio.unbind(endpoint);
+      } catch (const zmq::error_t &) {
+      }
+    }
+    active_endpoints.clear();
+    // prioritise the latest frame, while leaving room for every level of
+    // detail of one frame, since they're sent back to back and a receiver
+    // discards a frame that's missing any of them. the high water mark
+    // only applies to endpoints attached after it's set, which is why a
+    // change in level count reattaches them.
+    radio.set(zmq::sockopt::sndhwm, level_count);
+    for (const auto &endpoint : parse_endpoints(endpoints, port)) {
+      try {
+        if (is_datagram_endpoint(endpoint)) {
+          radio.connect(endpoint);
+          active_endpoints.push_back(endpoint);
+        } else {
+          radio.bind(endpoint);
+          active_endpoints.push_back(radio.get(zmq::sockopt::last_endpoint));
+        }
+        pc::logger->info("Radio broadcasting on {}", endpoint);
+      } catch (const zmq::error_t &e) {
+        pc::logger->error("Radio failed to open '{}': {}", endpoint,
+                          e.what());
+      }
+    }
+    applied_endpoints = std::move(endpoints);
+    applied_port = port;
+    applied_level_count = level_count;
+    // so that receivers on the new endpoints don't wait for the interval
+    request_keyframe = true;
+  };
+
+  // stamps the header onto an encoded message and sends it. the bytes are
+  // handed to zeromq rather than copied into the message, and freed once
+  // every endpoint has sent them.
+  const auto send = [&](std::unique_ptr<bob::types::bytes> bytes,
+                        const FrameHeader &header, const char *group) {
+    write_frame_header(header, bytes->data());
+    const auto size = bytes->size();
+    zmq::message_t msg(
+        bytes->data(), size,
+        [](void *, void *hint) {
+          delete static_cast<bob::types::bytes *>(hint);
+        },
+        bytes.get());
+    bytes.release();
+    msg.set_group(group);
+    radio.send(msg, zmq::send_flags::none);
+    return size;
+  };
+
+  std::array<std::string, max_lod_levels> lod_groups;
+  for (std::size_t level = 0; level < lod_groups.size(); level++) {
+    lod_groups[level] = fmt::format("live/lod{}", level);
+  }
+
+  unsigned int broadcast_snapshot_frame_count = 0;
+  std::uint64_t last_sent_sequence = 0;
+  std::uint64_t broadcast_sequence = 0;
+
+  while (!st.stop_requested()) {
+    apply_endpoints(std::clamp(_config.lod_levels, 1, max_lod_levels));
+
+    EncodedFrame encoded;
+    if (!_frames_to_send.pop(encoded, 50ms)) continue;
+
+    // encoders can finish out of order, and a frame older than one that's
+    // already been sent is stale
+    if (encoded.sequence <= last_sent_sequence) {
+      _dropped_frames++;
+      continue;
+    }
+    last_sent_sequence = encoded.sequence;
+
+    ZoneScopedN("Radio::send_frames");
+
+    // if (snapshots::frames.size() != broadcast_snapshot_frame_count) {
+
+    //   if (snapshots::frames.size() == 0) {
+    //     zmq::message_t snapshot_frame_msg(std::string_view("clear"));
+    //     snapshot_frame_msg.set_group("snapshots");
+    //     radio.send(snapshot_frame_msg, zmq::send_flags::none);
+    //   } else {
+    //     auto synthesized_snapshot_frame = std::reduce(
+    //         snapshots::frames.begin(), snapshots::frames.end(),
+    //         types::PointCloud{},
+    //         [](auto a, auto b) -> types::PointCloud { return a + b;
+    //         });
+    //     auto bytes = synthesized_snapshot_frame.serialize(
+    //         _config.compress_frames);
+    //     zmq::message_t snapshot_frames_msg(bytes);
+    //     snapshot_frames_msg.set_group("snapshots");
+    //     radio.send(snapshot_frames_msg, zmq::send_flags::none);
+    //   }
+    //   broadcast_snapshot_frame_count = snapshots::frames.size();
+    // }
+
+    FrameHeader header;
+    if (encoded.voxels) {
+      ZoneScopedN("Radio::send_frames::delta");
+      const auto delta_start_time = steady_clock::now();
+      const bool keyframe =
+          request_keyframe ||
+          frames_since_keyframe >= _config.keyframe_interval ||
+          delta_encoder.needs_keyframe(*encoded.voxels);
+      const DeltaThresholds thresholds{_config.delta_position_threshold,
+                                       _config.delta_color_threshold};
+      encoded.bytes = std::make_unique<bob::types::bytes>(
+          delta_encoder.encode(*encoded.voxels, keyframe, thresholds,
+                               _config.compress_frames, sizeof(FrameHeader)));
+      header.encoding =
+          keyframe ? FrameEncoding::Keyframe : FrameEncoding::Delta;
+      request_keyframe = false;
+      frames_since_keyframe = keyframe ? 1 : frames_since_keyframe + 1;
+      const auto delta_ms =
+          duration<float, std::milli>(steady_clock::now() - delta_start_time)
+              .count();
+      encoded.encode_ms += delta_ms;
+      TracyPlot("Radio delta encode ms", delta_ms);
+      TracyPlot("Radio delta voxels updated",
+                static_cast<int64_t>(delta_encoder.updated_voxel_count()));
+      TracyPlot("Radio delta voxels removed",
+                static_cast<int64_t>(delta_encoder.removed_voxel_count()));
+    } else {
+      // a delta after any other kind of frame would apply to a frame
+      // receivers never decoded
+      request_keyframe = true;
+    }
+
+    const auto start_send_time = steady_clock::now();
+    // counts the frames actually sent, so receivers only see a gap when a
+    // frame with new sensor data was dropped somewhere along the way
+    header.sequence = ++broadcast_sequence;
+    header.capture_time_us = unix_time_us(encoded.capture_timestamp);
+    header.send_time_us = unix_time_us(steady_clock::now());
+
+    std::size_t packet_bytes = 0;
+    if (!encoded.levels.empty()) {
+      header.level_count = static_cast<std::uint16_t>(encoded.levels.size());
+      for (std::size_t level = 0; level < encoded.levels.size(); level++) {
+        header.level = static_cast<std::uint16_t>(level);
+        packet_bytes += send(std::move(encoded.levels[level]), header,
+                             lod_groups[level].c_str());
+      }
+    } else {
+      packet_bytes = send(std::move(encoded.bytes), header, "live");
+    }
+
+    const auto sent_time = steady_clock::now();
+    const auto send_ms =
+        duration<float, std::milli>(sent_time - start_send_time).count();
+    const auto latency_ms =
+        duration<float, std::milli>(sent_time - encoded.capture_timestamp)
+            .count();
+    TracyPlot("Radio send ms", send_ms);
+    TracyPlot("Radio latency ms", latency_ms);
+
+    if (_config.capture_stats) {
+      std::lock_guard lock(stats_access);
+      encode_durations.push_back(encoded.encode_ms);
+      send_durations.push_back(send_ms);
+      latencies.push_back(latency_ms);
+      frame_sizes.push_back(packet_bytes / (float)1024);
+      constexpr auto max_stats_count = 300;
+      if (send_durations.size() > max_stats_count) {
+        encode_durations.clear();
+        send_durations.clear();
+        latencies.clear();
+        frame_sizes.clear();
+      }
+    }
+  }
+
+  pc::logger->info("Ended radio sender thread");
+}
+
+void Radio::request_endpoints() {
+  std::lock_guard lock(_endpoints_access);
+  _requested_endpoints = _config.endpoints;
+  _requested_port = _config.port;
+}
+
+static void draw_stat_summary(const char *label, const StatSummary &summary,
+                              const char *format) {
+  ImGui::Text("%s", label);
+  ImGui::BeginTable(label, 2);
+  ImGui::TableNextColumn();
+  ImGui::Text("Average");
+  ImGui::TableNextColumn();
+  ImGui::Text(format, summary.average);
+  ImGui::TableNextColumn();
+  ImGui::Text("Min");
+  ImGui::TableNextColumn();
+  ImGui::Text(format, summary.min);
+  ImGui::TableNextColumn();
+  ImGui::Text("Max");
+  ImGui::TableNextColumn();
+  ImGui::Text(format, summary.max);
+  ImGui::EndTable();
   ImGui::Spacing();
+}
+
+void Radio::draw_imgui_window() {
+
+  ImGui::Begin("Radio", nullptr);
+  pc::gui::draw_parameters("radio", struct_parameters.at("radio"));
+
   if (_config.capture_stats) {
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::Spacing();
+
     stats_frame_counter++;
     if (stats_frame_counter == 30) {
       stats_frame_counter = 0;
       std::lock_guard lock(stats_access);
-      if (send_durations.size() > 0) {
-        avg_duration =
-            std::reduce(send_durations.begin(), send_durations.end()) /
-            send_durations.size();
-        const auto minmax =
-            std::minmax_element(send_durations.begin(), send_durations.end());
-        minmax_duration = {*minmax.first, *minmax.second};
-      }
-      if (frame_sizes.size() > 0) {
-        avg_size = std::reduce(frame_sizes.begin(), frame_sizes.end()) /
-                   frame_sizes.size();
-        const auto minmax =
-            std::minmax_element(frame_sizes.begin(), frame_sizes.end());
-        minmax_size = {*minmax.first, *minmax.second};
-      }
+      encode_summary = summarise(encode_durations);
+      send_summary = summarise(send_durations);
+      latency_summary = summarise(latencies);
+      size_summary = summarise(frame_sizes);
     }
-    if (avg_duration != 0) {
-      ImGui::Text("Packet Send Duration");
-      ImGui::BeginTable("duration", 2);
-      ImGui::TableNextColumn();
-      ImGui::Text("Average");
-      ImGui::TableNextColumn();
-      ImGui::Text("%ims", (int)avg_duration);
-      ImGui::TableNextColumn();
-      ImGui::Text("Min");
-      ImGui::TableNextColumn();
-      ImGui::Text("%ims", minmax_duration.first);
-      ImGui::TableNextColumn();
-      ImGui::Text("Max");
-      ImGui::TableNextColumn();
-      ImGui::Text("%ims", minmax_duration.second);
-      ImGui::EndTable();
-      ImGui::Spacing();
-      ImGui::Text("Packet Size");
-      ImGui::BeginTable("duration", 2);
-      ImGui::TableNextColumn();
-      ImGui::Text("Average");
-      ImGui::TableNextColumn();
-      ImGui::Text("%fKB", avg_size);
-      ImGui::TableNextColumn();
-      ImGui::Text("Min");
-      ImGui::TableNextColumn();
-      ImGui::Text("%fKB", minmax_size.first);
-      ImGui::TableNextColumn();
-      ImGui::Text("Max");
-      ImGui::TableNextColumn();
-      ImGui::Text("%fKB", minmax_size.second);
-      ImGui::EndTable();
-      ImGui::Spacing();
-      ImGui::Text("%.0f Mbps", (avg_size / (float)1024) * 8 * 30);
+    if (send_summary.average != 0) {
+      draw_stat_summary("Encode Duration", encode_summary, "%.1fms");
+      draw_stat_summary("Send Duration", send_summary, "%.1fms");
+      draw_stat_summary("Latency", latency_summary, "%.1fms");
+      draw_stat_summary("Packet Size", size_summary, "%.0fKB");
+      ImGui::Text("%.0f Mbps", (size_summary.average / (float)1024) * 8 * 30);
+      ImGui::Text("%zu frames dropped", _dropped_frames.load());
       ImGui::Spacing();
     } else {
       ImGui::Text("Calculating...");
     }
   }
 
-  ImGui::PopItemWidth();
   ImGui::End();
-  ImGui::PopID();
+  request_endpoints();
 }
 
 } // namespace pc::radio
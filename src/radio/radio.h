@@ -1,19 +1,71 @@
 #include "radio_config.gen.h"
-#include "../operators/session_operator_host.h"
+#include "../devices/frame_bus.h"
+#include "../utils/dropping_queue.h"
+#include "delta_codec.h"
+#include "frame_header.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace pc::radio {
 
+// Broadcasts frames from the frame bus in three stages, each on its own
+// threads. The selector takes each new frame as soon as the bus publishes
+// it (up to the configured rate), a set of encoders serialize and compress
+// them in parallel, and the sender stamps and broadcasts them. Stages are
+// joined by short queues that drop their oldest frame when full, so slow
+// encoding adds latency rather than lowering the broadcast rate.
 class Radio {
 public:
-  Radio(RadioConfiguration& config, pc::operators::SessionOperatorHost& session_operator_host);
+  Radio(RadioConfiguration& config, pc::devices::FrameBus& frame_bus);
 
   void draw_imgui_window();
 
 private:
+  struct EncodedFrame {
+    std::uint64_t sequence = 0;
+    std::chrono::steady_clock::time_point capture_timestamp;
+    // a FrameHeader followed by the serialized point cloud
+    std::unique_ptr<bob::types::bytes> bytes;
+    // with delta encoding, the bucketed frame left for the sender to encode
+    // instead
+    std::unique_ptr<VoxelFrame> voxels;
+    // with levels of detail, each level's header and serialized points
+    // instead
+    std::vector<std::unique_ptr<bob::types::bytes>> levels;
+    float encode_ms = 0;
+  };
+
+  static constexpr std::size_t queue_capacity = 2;
+
   RadioConfiguration& _config;
-  pc::operators::SessionOperatorHost& _session_operator_host;
-  std::unique_ptr<std::jthread> _radio_thread;
+  pc::devices::FrameBus& _frame_bus;
+
+  // the endpoint settings are strings edited from the gui thread, so the
+  // sender thread only reads copies handed over under this lock
+  std::mutex _endpoints_access;
+  std::string _requested_endpoints;
+  int _requested_port;
+
+  pc::utils::DroppingQueue<pc::devices::FrameRef> _frames_to_encode{
+      queue_capacity};
+  pc::utils::DroppingQueue<EncodedFrame> _frames_to_send{queue_capacity};
+  std::atomic<std::size_t> _dropped_frames = 0;
+
+  // declared last so the stages stop before the queues are destroyed
+  std::jthread _selector_thread;
+  std::vector<std::jthread> _encoder_threads;
+  std::jthread _sender_thread;
+
+  void select_frames(std::stop_token st);
+  void encode_frames(std::stop_token st);
+  void send_frames(std::stop_token st);
+
+  void request_endpoints();
 };
 } // namespace pc::radio
@@ -7,8 +7,35 @@ namespace pc::radio {
 
 struct RadioConfiguration {
   int port = 9999;
+  // comma separated zeromq endpoints to broadcast on, e.g.
+  // "tcp://*:9999, ipc:///tmp/pointcaster, udp://192.168.1.20:9999".
+  // tcp, ipc and inproc endpoints are bound. udp endpoints name the dish to
+  // send datagrams to, and only carry frames small enough for one datagram.
+  // when empty the radio binds tcp://*:port
+  std::string endpoints = ""; // @optional
   bool enabled = false;
+  // frames are sent as soon as they're synthesized, up to this many per
+  // second. zero sends every frame.
+  int max_frame_rate = 30; // @minmax(0, 120) @optional
   bool compress_frames;
+  int encoding = 0; // 0: full frames, 1: keyframes and deltas // @optional
+  // with delta encoding a complete keyframe is sent this often, which is
+  // also as long as a newly joined receiver waits for its first frame
+  int keyframe_interval = 30; // @minmax(1, 300) @optional
+  // delta encoding compares frames in voxels of this size in mm
+  float delta_voxel_size = 50.0f; // @minmax(5, 500) @optional
+  // a voxel is sent again once its average position has moved this far in
+  // mm since it was last sent
+  float delta_position_threshold = 5.0f; // @minmax(0, 100) @optional
+  // or once any channel of its average colour has changed this much
+  float delta_color_threshold = 12.0f; // @minmax(0, 255) @optional
+  // above one, frames are split into this many octree levels of detail and
+  // sent on the groups live/lod0, live/lod1 and so on, each adding detail
+  // to the levels before it. delta encoding only applies to a single level.
+  int lod_levels = 1; // @minmax(1, 6) @optional
+  // cell size in mm of the coarsest level of detail, rounded to a power of
+  // two. each level after it halves the cell size.
+  float lod_cell_size = 256.0f; // @minmax(16, 4096) @optional
   bool capture_stats;
 };
 
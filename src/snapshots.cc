@@ -57,7 +57,11 @@ void Snapshots::draw_imgui_window() {
 
 void Snapshots::capture() {
   pc::logger->info("Capturing frame");
-  frames.push_back({pc::devices::synthesized_point_cloud()});
+  // snapshots hold the published frame, so they include the effect of the
+  // session operators rather than the raw merged sensor output
+  auto frame = _frame_bus.latest();
+  if (!frame) return;
+  frames.push_back(frame->point_cloud);
 }
 
 } // namespace pc::snapshots
@@ -4,6 +4,7 @@
 #include <vector>
 #include <pointclouds.h>
 #include "structs.h"
+#include "devices/frame_bus.h"
 
 namespace pc::snapshots {
 
@@ -15,10 +16,12 @@ struct SnapshotsConfiguration {
 
 class Snapshots {
 public:
-  Snapshots(){};
-  Snapshots(SnapshotsConfiguration config) : _config{config} {}
+  Snapshots(pc::devices::FrameBus &frame_bus) : _frame_bus(frame_bus){};
+  Snapshots(pc::devices::FrameBus &frame_bus, SnapshotsConfiguration config)
+      : _frame_bus(frame_bus), _config{config} {}
   void draw_imgui_window();
 private:
+  pc::devices::FrameBus &_frame_bus;
   SnapshotsConfiguration _config{};
   void capture();
 };
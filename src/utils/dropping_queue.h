@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+#include <cstddef>
+#include <utility>
+
+namespace pc::utils {
+
+// A bounded lock-free queue between pipeline stages that makes room for new
+// items by dropping its oldest ones instead of blocking the producer, so a
+// slow consumer only ever works on recent items.
+//
+// The bound is approximate when there are several producers, since the
+// underlying queue only orders items from the same producer.
+template <typename T> class DroppingQueue {
+public:
+  explicit DroppingQueue(std::size_t capacity)
+      : _capacity(capacity), _queue(capacity) {}
+
+  DroppingQueue(const DroppingQueue &) = delete;
+  DroppingQueue &operator=(const DroppingQueue &) = delete;
+
+  // returns how many queued items were dropped to make room
+  std::size_t push(T item) {
+    std::size_t dropped = 0;
+    T oldest;
+    while (_queue.size_approx() >= _capacity && _queue.try_dequeue(oldest)) {
+      dropped++;
+    }
+    _queue.enqueue(std::move(item));
+    return dropped;
+  }
+
+  bool pop(T &item, std::chrono::microseconds timeout) {
+    return _queue.wait_dequeue_timed(item, timeout);
+  }
+
+private:
+  std::size_t _capacity;
+  moodycamel::BlockingConcurrentQueue<T> _queue;
+};
+
+} // namespace pc::utils
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace pc::utils {
+
+// Lock-free single-producer single-consumer handoff where the latest value
+// wins. The producer always owns a back slot and the consumer always owns a
+// front slot, with a third slot in between that they exchange by atomically
+// swapping indices, so neither side ever waits on the other.
+//
+// This only tracks slot indices, so it can coordinate buffers that live
+// elsewhere (e.g. in device memory). TripleBuffer<T> below holds the values
+// itself.
+class TripleBufferIndex {
+public:
+  // the slot the producer is free to write into
+  int back() const { return _back; }
+
+  // the slot the consumer is free to read from
+  int front() const { return _front; }
+
+  // producer: hand the back slot to the consumer, replacing any published
+  // slot it hasn't picked up yet
+  void publish() {
+    const auto previous =
+        _middle.exchange(_back | dirty_bit, std::memory_order_acq_rel);
+    _back = previous & index_mask;
+  }
+
+  // consumer: take the most recently published slot as the new front.
+  // returns false, leaving the front unchanged, if nothing new has been
+  // published since the last call.
+  bool acquire() {
+    if (!(_middle.load(std::memory_order_relaxed) & dirty_bit)) return false;
+    const auto previous = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = previous & index_mask;
+    return true;
+  }
+
+private:
+  static constexpr std::uint8_t dirty_bit = 0b100;
+  static constexpr std::uint8_t index_mask = 0b011;
+
+  int _back = 0;
+  std::atomic<std::uint8_t> _middle{1};
+  int _front = 2;
+};
+
+template <typename T> class TripleBuffer {
+public:
+  T &back() { return _slots[_index.back()]; }
+  void publish() { _index.publish(); }
+
+  bool acquire() { return _index.acquire(); }
+  T &front() { return _slots[_index.front()]; }
+
+private:
+  std::array<T, 3> _slots{};
+  TripleBufferIndex _index;
+};
+
+} // namespace pc::utils
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace pc::utils {
+
+// A counter that producers bump whenever something new is available, so a
+// consumer can sleep until there's work instead of polling on a timer. The
+// consumer remembers the last count it handled and waits for it to change,
+// so notifications that arrive while it's busy are never lost, and any
+// number of them are coalesced into one wake up.
+class UpdateSignal {
+public:
+  void notify() {
+    {
+      std::lock_guard lock(_access);
+      _count++;
+    }
+    _updated.notify_all();
+  }
+
+  std::uint64_t count() const {
+    std::lock_guard lock(_access);
+    return _count;
+  }
+
+  // blocks until the count differs from after_count or the timeout expires,
+  // returning the count at that point
+  template <typename Rep, typename Period>
+  std::uint64_t wait_for(std::uint64_t after_count,
+                         std::chrono::duration<Rep, Period> timeout) const {
+    std::unique_lock lock(_access);
+    _updated.wait_for(lock, timeout, [&] { return _count != after_count; });
+    return _count;
+  }
+
+private:
+  mutable std::mutex _access;
+  mutable std::condition_variable _updated;
+  std::uint64_t _count = 0;
+};
+
+} // namespace pc::utils
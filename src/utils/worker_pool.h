@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pc::utils {
+
+// A fixed set of worker threads pulling tasks from a shared queue, so that
+// per-frame work can be fanned out across cores without spawning a new thread
+// for every task.
+class WorkerPool {
+public:
+  explicit WorkerPool(
+      std::size_t thread_count = std::max(1u,
+                                          std::thread::hardware_concurrency())) {
+    _threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; i++) {
+      _threads.emplace_back([this](std::stop_token st) {
+        using namespace std::chrono_literals;
+        std::function<void()> task;
+        while (!st.stop_requested()) {
+          if (_tasks.wait_dequeue_timed(task, 50ms)) task();
+        }
+      });
+    }
+  }
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  std::size_t thread_count() const { return _threads.size(); }
+
+  template <typename Func>
+  std::future<std::invoke_result_t<Func>> submit(Func &&func) {
+    using R = std::invoke_result_t<Func>;
+    auto task =
+        std::make_shared<std::packaged_task<R()>>(std::forward<Func>(func));
+    auto future = task->get_future();
+    _tasks.enqueue([task] { (*task)(); });
+    return future;
+  }
+
+  // Runs func(i) for every i in [0, count) and blocks until all have
+  // completed. The calling thread runs the first index itself and helps drain
+  // the queue while it waits, so nested calls from inside a worker can't
+  // starve the pool.
+  template <typename Func> void parallel_for(std::size_t count, Func &&func) {
+    if (count == 0) return;
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(count - 1);
+    for (std::size_t i = 1; i < count; i++) {
+      futures.push_back(submit([&func, i] { func(i); }));
+    }
+
+    func(0);
+
+    using namespace std::chrono_literals;
+    for (auto &future : futures) {
+      while (future.wait_for(0s) != std::future_status::ready) {
+        std::function<void()> task;
+        if (_tasks.try_dequeue(task)) task();
+        else future.wait_for(100us);
+      }
+      // rethrows anything thrown inside the task
+      future.get();
+    }
+  }
+
+private:
+  moodycamel::BlockingConcurrentQueue<std::function<void()>> _tasks;
+  std::vector<std::jthread> _threads;
+};
+
+// Shared pool for frame processing work
+inline WorkerPool &worker_pool() {
+  static WorkerPool pool;
+  return pool;
+}
+
+} // namespace pc::utils
@@ -0,0 +1,165 @@
+// Compares the compute backends on the same work: the ingest stage and a
+// per-device operator chain (rotate, noise and a sample filter, fused as
+// they are by default) over a generated K4A-sized sensor frame. It runs on
+// the host (OpenMP) backend and, when a CUDA device is present, on the GPU,
+// and reports throughput the way the "Ingest points/ms" plots do.
+//
+//   backend-bench [runs]
+
+#include "../src/devices/ingest/ingest_point.cuh"
+#include "../src/operators/fused_operator.cuh"
+#include "bench_utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thrust/copy.h>
+#include <thrust/device_vector.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <thrust/system/omp/execution_policy.h>
+#include <vector>
+
+using namespace pc::bench;
+using namespace pc::devices;
+using namespace pc::operators;
+
+namespace {
+
+// matches K4ADriver::incoming_point_count (512x512 NFOV unbinned)
+constexpr std::size_t frame_point_count = 512 * 512;
+
+struct SensorFrame {
+  std::vector<Short3> positions;
+  std::vector<color> colors;
+};
+
+// sensors report pixels they couldn't see as black, and ingest drops those
+SensorFrame sensor_frame() {
+  const auto cloud = synthetic_cloud(frame_point_count);
+  SensorFrame frame;
+  frame.positions.resize(frame_point_count);
+  frame.colors = cloud.colors;
+  for (std::size_t i = 0; i < frame_point_count; i++) {
+    const auto &p = cloud.positions[i];
+    frame.positions[i] = {p.x, p.y, p.z};
+    if (i % 10 == 0) frame.colors[i] = {0, 0, 0, 0};
+  }
+  return frame;
+}
+
+FusedOperator operator_chain() {
+  RotateOperatorConfiguration rotate{};
+  rotate.euler_angles = {0, 30, 0};
+  NoiseOperatorConfiguration noise{};
+  SampleFilterOperatorConfiguration sample_filter{};
+  sample_filter.sample_count = 2;
+
+  FusedOperator chain;
+  chain.push(rotate);
+  chain.push(noise);
+  chain.push(sample_filter);
+  return chain;
+}
+
+struct BackendResult {
+  Timing timing;
+  std::size_t output_count;
+};
+
+// the same stages as IngestPipeline::process_host and process_cuda, with the
+// per-device operators that follow them
+template <typename ExecutionPolicy, typename PositionIterator,
+          typename ColorIterator, typename OutputIterator>
+OutputIterator ingest(const ExecutionPolicy &policy,
+                      PositionIterator incoming_positions,
+                      ColorIterator incoming_colors, OutputIterator output,
+                      const ingest_point &ingest_stage,
+                      const FusedOperator &chain) {
+  auto incoming_points_begin = thrust::make_zip_iterator(thrust::make_tuple(
+      incoming_positions, incoming_colors, thrust::make_counting_iterator(0)));
+  auto ingested_points_begin =
+      thrust::make_transform_iterator(incoming_points_begin, ingest_stage);
+  auto output_end = thrust::copy_if(policy, ingested_points_begin,
+                                    ingested_points_begin + frame_point_count,
+                                    output, is_ingested{});
+  return run_fused(policy, output, output_end, chain);
+}
+
+BackendResult host_backend(const SensorFrame &frame,
+                           const ingest_point &ingest_stage,
+                           const FusedOperator &chain, int run_count) {
+  std::vector<position> output_positions(frame_point_count);
+  std::vector<color> output_colors(frame_point_count);
+  std::vector<int> output_indices(frame_point_count);
+  const auto output_begin = thrust::make_zip_iterator(
+      thrust::make_tuple(output_positions.data(), output_colors.data(),
+                         output_indices.data()));
+  auto output_end = output_begin;
+
+  HostScratchAllocator allocator;
+  const auto policy = thrust::omp::par(allocator);
+  const auto timing = time_runs(run_count, [&] {
+    output_end = ingest(policy, frame.positions.data(), frame.colors.data(),
+                        output_begin, ingest_stage, chain);
+  });
+  return {timing, static_cast<std::size_t>(output_end - output_begin)};
+}
+
+BackendResult cuda_backend(const SensorFrame &frame,
+                           const ingest_point &ingest_stage,
+                           const FusedOperator &chain, int run_count) {
+  const thrust::device_vector<Short3> incoming_positions(frame.positions);
+  const thrust::device_vector<color> incoming_colors(frame.colors);
+  thrust::device_vector<position> output_positions(frame_point_count);
+  thrust::device_vector<color> output_colors(frame_point_count);
+  thrust::device_vector<int> output_indices(frame_point_count);
+  const auto output_begin = thrust::make_zip_iterator(
+      thrust::make_tuple(output_positions.begin(), output_colors.begin(),
+                         output_indices.begin()));
+  auto output_end = output_begin;
+
+  DeviceScratchAllocator allocator;
+  const auto policy = thrust::cuda::par(allocator);
+  const auto timing = time_runs(run_count, [&] {
+    output_end = ingest(policy, incoming_positions.begin(),
+                        incoming_colors.begin(), output_begin, ingest_stage,
+                        chain);
+    cudaDeviceSynchronize();
+  });
+  return {timing, static_cast<std::size_t>(output_end - output_begin)};
+}
+
+void print(const char *backend, const BackendResult &result) {
+  std::printf("%-8s %10.3f %10.3f %14.0f %12zu\n", backend,
+              result.timing.mean_ms, result.timing.min_ms,
+              frame_point_count / result.timing.mean_ms, result.output_count);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int run_count = argc > 1 ? std::atoi(argv[1]) : 50;
+  if (run_count < 1) {
+    std::fprintf(stderr, "usage: %s [runs]\n", argv[0]);
+    return 1;
+  }
+
+  const auto frame = sensor_frame();
+  const DeviceConfiguration config{};
+  const ingest_point ingest_stage(config, Eigen::Matrix4f::Identity());
+  const auto chain = operator_chain();
+  const bool with_cuda = cuda_device_available();
+
+  std::printf("%zu point frames through ingest, rotate, noise and a sample "
+              "filter, mean of %d runs%s\n\n",
+              frame_point_count, run_count,
+              with_cuda ? "" : ", no CUDA device found");
+  std::printf("%-8s %10s %10s %14s %12s\n", "backend", "mean ms", "min ms",
+              "points/ms", "points out");
+
+  print("host", host_backend(frame, ingest_stage, chain, run_count));
+  if (with_cuda) {
+    print("cuda", cuda_backend(frame, ingest_stage, chain, run_count));
+  }
+  return 0;
+}
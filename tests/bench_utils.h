@@ -0,0 +1,104 @@
+#pragma once
+
+// Synthetic input and timing shared by the benchmarks that don't take a
+// recording, so every backend and configuration they compare sees the
+// same points.
+
+#include "../src/structs.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#ifdef __CUDACC__
+#include <cuda_runtime_api.h>
+#endif
+
+namespace pc::bench {
+
+using pc::types::color;
+using pc::types::position;
+
+struct SyntheticCloud {
+  std::vector<position> positions;
+  std::vector<color> colors;
+
+  std::size_t size() const { return positions.size(); }
+};
+
+// A world-space cloud shaped like one a sensor sees: a gently curved
+// surface 4m across and about 2m away, with a small share of stray points
+// scattered through the volume in front of it the way depth noise is. The
+// same seed always gives the same cloud.
+inline SyntheticCloud synthetic_cloud(std::size_t point_count,
+                                      unsigned seed = 1) {
+  constexpr float stray_share = 0.02f;
+
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> across(-2000, 2000);
+  std::uniform_real_distribution<float> unit(0, 1);
+  std::uniform_int_distribution<int> channel(1, 255);
+
+  SyntheticCloud cloud;
+  cloud.positions.resize(point_count);
+  cloud.colors.resize(point_count);
+  for (std::size_t i = 0; i < point_count; i++) {
+    const float x = across(random);
+    const float y = across(random);
+    float z = 2000 + 200 * std::sin(x / 300) * std::cos(y / 300);
+    if (unit(random) < stray_share) z = 500 + 3000 * unit(random);
+    cloud.positions[i] = {static_cast<short>(x), static_cast<short>(y),
+                          static_cast<short>(z), 0};
+    cloud.colors[i] = {static_cast<std::uint8_t>(channel(random)),
+                       static_cast<std::uint8_t>(channel(random)),
+                       static_cast<std::uint8_t>(channel(random)), 255};
+  }
+  return cloud;
+}
+
+struct Timing {
+  double mean_ms = 0;
+  double min_ms = 0;
+};
+
+// Calls function once untimed, so scratch allocators and caches reach the
+// state they're in during a session, and then times run_count calls. setup
+// is called before every call and isn't timed, for functions that consume
+// their input.
+template <typename Setup, typename Function>
+Timing time_runs(int run_count, Setup &&setup, Function &&function) {
+  using namespace std::chrono;
+  setup();
+  function();
+  Timing timing{0, std::numeric_limits<double>::max()};
+  for (int run = 0; run < run_count; run++) {
+    setup();
+    const auto start_time = steady_clock::now();
+    function();
+    const duration<double, std::milli> run_time =
+        steady_clock::now() - start_time;
+    timing.mean_ms += run_time.count();
+    timing.min_ms = std::min(timing.min_ms, run_time.count());
+  }
+  timing.mean_ms /= std::max(run_count, 1);
+  return timing;
+}
+
+template <typename Function>
+Timing time_runs(int run_count, Function &&function) {
+  return time_runs(run_count, [] {}, std::forward<Function>(function));
+}
+
+#ifdef __CUDACC__
+inline bool cuda_device_available() {
+  int device_count = 0;
+  return cudaGetDeviceCount(&device_count) == cudaSuccess && device_count > 0;
+}
+#endif
+
+} // namespace pc::bench
@@ -0,0 +1,164 @@
+// Round trips voxel frames through DeltaEncoder and DeltaDecoder, checking
+// that receivers rebuild exactly the voxels the encoder meant them to have.
+
+#include "../src/radio/delta_codec.h"
+#include <cstdio>
+#include <initializer_list>
+
+using namespace pc::radio;
+using bob::types::color;
+using bob::types::PointCloud;
+using bob::types::position;
+
+namespace {
+
+constexpr float voxel_size = 100;
+// thresholds are left at their defaults (5mm, 12 colour steps)
+constexpr DeltaThresholds thresholds{};
+
+int failure_count = 0;
+
+void check(bool condition, const char *description) {
+  if (condition) return;
+  std::fprintf(stderr, "FAILED: %s\n", description);
+  failure_count++;
+}
+
+struct Point {
+  short x, y, z;
+  std::uint8_t r, g, b;
+};
+
+// the voxels used here all sit side by side along x, so x / voxel_size is
+// the voxel a point lands in, and voxels are in key order
+PointCloud cloud(std::initializer_list<Point> points) {
+  PointCloud result;
+  for (const auto &p : points) {
+    result.positions.push_back({p.x, p.y, p.z, 0});
+    result.colors.push_back({p.r, p.g, p.b, 255});
+  }
+  return result;
+}
+
+PointCloud concat(std::initializer_list<PointCloud> clouds) {
+  PointCloud result;
+  for (const auto &c : clouds) {
+    result.positions.insert(result.positions.end(), c.positions.begin(),
+                            c.positions.end());
+    result.colors.insert(result.colors.end(), c.colors.begin(),
+                         c.colors.end());
+  }
+  return result;
+}
+
+bool same_points(const PointCloud &lhs, const PointCloud &rhs) {
+  if (lhs.size() != rhs.size()) return false;
+  for (std::size_t i = 0; i < lhs.size(); i++) {
+    const auto &a = lhs.positions[i];
+    const auto &b = rhs.positions[i];
+    const auto &ca = lhs.colors[i];
+    const auto &cb = rhs.colors[i];
+    if (a.x != b.x || a.y != b.y || a.z != b.z) return false;
+    if (ca.r != cb.r || ca.g != cb.g || ca.b != cb.b) return false;
+  }
+  return true;
+}
+
+// what a receiver should hold: the given points in voxel order
+PointCloud bucketed(const PointCloud &points) {
+  VoxelFrame frame;
+  frame.bucket(points, voxel_size);
+  return frame.points;
+}
+
+bool decode(DeltaDecoder &decoder, const bob::types::bytes &data,
+            bool keyframe) {
+  return decoder.decode(data.data(), data.size(), keyframe);
+}
+
+} // namespace
+
+int main() {
+  // voxel 0 stays put, voxel 1 disappears, voxel 2 moves, voxel 3 appears
+  const auto voxel_0 = cloud({{10, 10, 10, 200, 0, 0}, {20, 30, 40, 200, 0, 0}});
+  const auto voxel_0_drifted =
+      cloud({{11, 10, 10, 201, 0, 0}, {21, 30, 40, 201, 0, 0}});
+  const auto voxel_1 = cloud({{150, 50, 50, 0, 200, 0}});
+  const auto voxel_2 = cloud({{210, 20, 20, 0, 0, 200}, {220, 20, 20, 0, 0, 200}});
+  const auto voxel_2_moved =
+      cloud({{260, 70, 70, 0, 0, 200}, {270, 70, 70, 0, 0, 200}});
+  const auto voxel_3 = cloud({{350, 50, 50, 90, 90, 90}});
+
+  const auto first_points = concat({voxel_0, voxel_1, voxel_2});
+  const auto second_points = concat({voxel_0_drifted, voxel_2_moved, voxel_3});
+
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+  VoxelFrame frame;
+
+  // a keyframe carries every voxel
+  frame.bucket(first_points, voxel_size);
+  check(encoder.needs_keyframe(frame), "a new encoder asks for a keyframe");
+  const auto keyframe = encoder.encode(frame, true, thresholds, false);
+  check(encoder.updated_voxel_count() == 3, "keyframe sends every voxel");
+  check(encoder.removed_voxel_count() == 0, "keyframe removes nothing");
+  check(decode(decoder, keyframe, true), "keyframe decodes");
+  check(same_points(decoder.point_cloud(), bucketed(first_points)),
+        "keyframe rebuilds the frame");
+
+  // a delta only carries what changed beyond the thresholds
+  frame.bucket(second_points, voxel_size);
+  check(!encoder.needs_keyframe(frame), "same voxel size allows a delta");
+  const auto delta = encoder.encode(frame, false, thresholds, false);
+  check(encoder.updated_voxel_count() == 2,
+        "delta sends the moved and the new voxel");
+  check(encoder.removed_voxel_count() == 1, "delta removes the empty voxel");
+  check(decode(decoder, delta, false), "delta decodes");
+  // the drift in voxel 0 is under the thresholds, so the receiver keeps the
+  // points it was first sent
+  check(same_points(decoder.point_cloud(),
+                    bucketed(concat({voxel_0, voxel_2_moved, voxel_3}))),
+        "delta keeps unchanged, replaces updated and drops removed voxels");
+
+  // reserved space in front of the payload is left for the caller
+  constexpr std::size_t reserved_bytes = 16;
+  const auto unchanged =
+      encoder.encode(frame, false, thresholds, false, reserved_bytes);
+  check(encoder.updated_voxel_count() == 0 &&
+            encoder.removed_voxel_count() == 0,
+        "re-encoding the same frame sends nothing");
+  check(decoder.decode(unchanged.data() + reserved_bytes,
+                       unchanged.size() - reserved_bytes, false),
+        "empty delta decodes");
+  check(same_points(decoder.point_cloud(),
+                    bucketed(concat({voxel_0, voxel_2_moved, voxel_3}))),
+        "empty delta leaves the frame as it was");
+
+  // after a lost frame, deltas are refused until the next keyframe
+  const auto before_invalidate = decoder.point_cloud();
+  decoder.invalidate();
+  frame.bucket(first_points, voxel_size);
+  const auto late_delta = encoder.encode(frame, false, thresholds, false);
+  check(!decode(decoder, late_delta, false),
+        "delta after invalidate() is refused");
+  check(same_points(decoder.point_cloud(), before_invalidate),
+        "refused delta leaves the frame unchanged");
+
+  const auto recovery = encoder.encode(frame, true, thresholds, false);
+  check(decode(decoder, recovery, true), "keyframe after invalidate() decodes");
+  check(same_points(decoder.point_cloud(), bucketed(first_points)),
+        "keyframe after invalidate() rebuilds the frame");
+
+  // truncated data is rejected rather than half applied
+  const auto next_delta = encoder.encode(frame, false, thresholds, false);
+  check(!decoder.decode(next_delta.data(), sizeof(DeltaPayloadHeader) - 1,
+                        false),
+        "truncated delta is refused");
+
+  if (failure_count > 0) {
+    std::fprintf(stderr, "%d checks failed\n", failure_count);
+    return 1;
+  }
+  std::printf("delta codec round trips passed\n");
+  return 0;
+}
@@ -0,0 +1,150 @@
+// Measures statistical and radius outlier removal over a synthetic cloud
+// with stray points in it, on the host (OpenMP) backend and, when a CUDA
+// device is present, on the GPU. Each run includes building the voxel grid,
+// as it does when denoise is the first spatial operator on the merged cloud.
+//
+//   denoise-bench [points] [radius mm] [runs]
+
+#include "../src/operators/denoise/denoise_operator.cuh"
+#include "bench_utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <numeric>
+#include <thrust/copy.h>
+#include <thrust/device_vector.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <thrust/system/omp/execution_policy.h>
+#include <vector>
+
+using namespace pc::bench;
+using namespace pc::operators;
+
+namespace {
+
+// the bar the CPU backend is held to for a million points
+constexpr double host_target_ms = 3.0;
+
+struct DenoiseResult {
+  Timing timing;
+  std::size_t removed_count;
+};
+
+// denoise reorders and removes points, so every run starts from a fresh
+// copy of the cloud, made outside the timed section
+DenoiseResult host_denoise(const SyntheticCloud &cloud,
+                           const DenoiseOperatorConfiguration &config,
+                           int run_count) {
+  std::vector<position> positions(cloud.size());
+  std::vector<color> colors(cloud.size());
+  std::vector<int> indices(cloud.size());
+
+  const auto begin = thrust::make_zip_iterator(thrust::make_tuple(
+      positions.data(), colors.data(), indices.data()));
+  auto end = begin + cloud.size();
+
+  HostScratchAllocator allocator;
+  const auto policy = thrust::omp::par(allocator);
+  const auto timing = time_runs(
+      run_count,
+      [&] {
+        std::copy(cloud.positions.begin(), cloud.positions.end(),
+                  positions.begin());
+        std::copy(cloud.colors.begin(), cloud.colors.end(), colors.begin());
+        std::iota(indices.begin(), indices.end(), 0);
+      },
+      [&] {
+        VoxelGridCache voxel_grids(allocator);
+        end = run_denoise(policy, voxel_grids, begin, begin + cloud.size(),
+                          config);
+      });
+  return {timing, cloud.size() - static_cast<std::size_t>(end - begin)};
+}
+
+DenoiseResult cuda_denoise(const SyntheticCloud &cloud,
+                           const DenoiseOperatorConfiguration &config,
+                           int run_count) {
+  const thrust::device_vector<position> source_positions(cloud.positions);
+  const thrust::device_vector<color> source_colors(cloud.colors);
+  thrust::device_vector<position> positions(cloud.size());
+  thrust::device_vector<color> colors(cloud.size());
+  thrust::device_vector<int> indices(cloud.size());
+
+  const auto begin = thrust::make_zip_iterator(thrust::make_tuple(
+      positions.begin(), colors.begin(), indices.begin()));
+  auto end = begin + cloud.size();
+
+  DeviceScratchAllocator allocator;
+  const auto policy = thrust::cuda::par(allocator);
+  const auto timing = time_runs(
+      run_count,
+      [&] {
+        thrust::copy(source_positions.begin(), source_positions.end(),
+                     positions.begin());
+        thrust::copy(source_colors.begin(), source_colors.end(),
+                     colors.begin());
+        thrust::sequence(indices.begin(), indices.end());
+        cudaDeviceSynchronize();
+      },
+      [&] {
+        VoxelGridCache voxel_grids(allocator);
+        end = run_denoise(policy, voxel_grids, begin, begin + cloud.size(),
+                          config);
+        cudaDeviceSynchronize();
+      });
+  return {timing, cloud.size() - static_cast<std::size_t>(end - begin)};
+}
+
+void print(const char *mode, const char *backend,
+           const DenoiseResult &result) {
+  std::printf("%-12s %-8s %10.3f %10.3f %14zu\n", mode, backend,
+              result.timing.mean_ms, result.timing.min_ms,
+              result.removed_count);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const long point_count = argc > 1 ? std::atol(argv[1]) : 1'000'000;
+  // the defaults match DenoiseOperatorConfiguration
+  DenoiseOperatorConfiguration config{};
+  if (argc > 2) config.radius = std::strtof(argv[2], nullptr);
+  const int run_count = argc > 3 ? std::atoi(argv[3]) : 20;
+  if (point_count < 1 || config.radius < 1 || run_count < 1) {
+    std::fprintf(stderr, "usage: %s [points] [radius mm] [runs]\n", argv[0]);
+    return 1;
+  }
+
+  const auto cloud = synthetic_cloud(point_count);
+  const bool with_cuda = cuda_device_available();
+
+  std::printf("%ld points, %.0fmm radius, mean of %d runs%s\n", point_count,
+              config.radius, run_count,
+              with_cuda ? "" : ", no CUDA device found");
+  std::printf("statistical: %d neighbours, %.1f standard deviations\n",
+              config.neighbour_count, config.std_dev_multiplier);
+  std::printf("radius: at least %d neighbours\n\n", config.min_neighbours);
+  std::printf("%-12s %-8s %10s %10s %14s\n", "mode", "backend", "mean ms",
+              "min ms", "points removed");
+
+  bool host_within_target = true;
+  for (const auto mode : {DenoiseMode::Statistical, DenoiseMode::Radius}) {
+    config.mode = static_cast<int>(mode);
+    const auto mode_name =
+        mode == DenoiseMode::Statistical ? "statistical" : "radius";
+
+    const auto host = host_denoise(cloud, config, run_count);
+    print(mode_name, "host", host);
+    if (host.timing.mean_ms > host_target_ms) host_within_target = false;
+
+    if (with_cuda) {
+      print(mode_name, "cuda", cuda_denoise(cloud, config, run_count));
+    }
+  }
+
+  if (point_count == 1'000'000) {
+    std::printf("\nhost backend %s the %.0f ms target for a million points\n",
+                host_within_target ? "meets" : "misses", host_target_ms);
+  }
+  return 0;
+}
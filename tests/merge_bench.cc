@@ -0,0 +1,84 @@
+// Measures the merge step of synthesized_point_cloud: sizing the output
+// arena from each device's point count and having every device download
+// into its own slice in parallel. Devices here hold their processed points
+// in host memory, as the host ingest backend does, so the download is the
+// same copy it makes.
+//
+//   merge-bench [points per device] [runs]
+//
+// The first table keeps the points per device fixed, so the total grows
+// with the device count. The second splits a fixed total across the
+// devices, so only the parallelism changes.
+
+#include "../src/devices/device_merge.h"
+#include "bench_utils.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace pc::bench;
+using pc::devices::merge_device_clouds;
+
+namespace {
+
+constexpr std::size_t max_device_count = 8;
+
+// runs one merge of the given devices per timed call into an arena that is
+// kept across runs, like the frame bus's reused frames
+Timing time_merges(const std::vector<SyntheticCloud> &devices, int run_count,
+                   std::size_t &merged_point_count) {
+  pc::types::PointCloud result;
+  const auto timing = time_runs(run_count, [&] {
+    merge_device_clouds(
+        result, devices.size(),
+        [&](std::size_t i) { return devices[i].size(); },
+        [&](std::size_t i, position *positions, color *colors) {
+          const auto &device = devices[i];
+          std::copy(device.positions.begin(), device.positions.end(),
+                    positions);
+          std::copy(device.colors.begin(), device.colors.end(), colors);
+        });
+  });
+  merged_point_count = result.size();
+  return timing;
+}
+
+void print_table(const char *title, std::size_t total_point_count,
+                 bool split_total, int run_count) {
+  std::printf("%s\n%8s %12s %10s %10s\n", title, "devices", "points",
+              "mean ms", "min ms");
+  for (std::size_t device_count = 1; device_count <= max_device_count;
+       device_count++) {
+    const auto points_per_device =
+        split_total ? total_point_count / device_count : total_point_count;
+    std::vector<SyntheticCloud> devices;
+    for (std::size_t i = 0; i < device_count; i++) {
+      devices.push_back(synthetic_cloud(points_per_device, i + 1));
+    }
+    std::size_t merged_point_count = 0;
+    const auto timing = time_merges(devices, run_count, merged_point_count);
+    std::printf("%8zu %12zu %10.3f %10.3f\n", device_count,
+                merged_point_count, timing.mean_ms, timing.min_ms);
+  }
+  std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // a K4A depth frame in NFOV unbinned mode, with every pixel kept
+  const long point_count = argc > 1 ? std::atol(argv[1]) : 512 * 512;
+  const int run_count = argc > 2 ? std::atoi(argv[2]) : 50;
+  if (point_count < 1 || run_count < 1) {
+    std::fprintf(stderr, "usage: %s [points per device] [runs]\n", argv[0]);
+    return 1;
+  }
+
+  std::printf("mean of %d merges, %zu worker threads\n\n", run_count,
+              pc::utils::worker_pool().thread_count());
+  print_table("fixed points per device", point_count, false, run_count);
+  print_table("fixed total split across devices", point_count, true,
+              run_count);
+  return 0;
+}
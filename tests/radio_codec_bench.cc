@@ -0,0 +1,159 @@
+// Measures the cost and size of each radio encoding over every frame of a
+// replay recording, so that delta encoding can be compared with sending
+// full Draco-compressed frames on the same data.
+//
+//   radio-codec-bench <recording.pcrec> [voxel size mm] [keyframe interval]
+//
+// Recordings hold raw sensor frames, so the clouds here are in sensor space
+// and skip the ingest stages and operators. That doesn't change what the
+// encoders have to do with them.
+
+#include "../src/devices/replay/recording.h"
+#include "../src/radio/delta_codec.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace pc::radio;
+using namespace std::chrono;
+using pc::devices::replay::RecordingReader;
+
+namespace {
+
+struct Measurements {
+  const char *name;
+  std::vector<float> milliseconds;
+  std::vector<float> bytes;
+
+  void print() const {
+    if (milliseconds.empty()) return;
+    const auto [min, max] =
+        std::minmax_element(milliseconds.begin(), milliseconds.end());
+    const auto mean =
+        std::reduce(milliseconds.begin(), milliseconds.end()) /
+        milliseconds.size();
+    std::printf("%-22s %8.3f %8.3f %8.3f", name, mean, *min, *max);
+    if (!bytes.empty()) {
+      const auto mean_bytes =
+          std::reduce(bytes.begin(), bytes.end()) / bytes.size();
+      std::printf(" %12.0f", mean_bytes);
+    }
+    std::printf("\n");
+  }
+};
+
+template <typename Function>
+auto timed(Measurements &measurements, Function &&function) {
+  const auto start_time = steady_clock::now();
+  auto result = function();
+  measurements.milliseconds.push_back(
+      duration<float, std::milli>(steady_clock::now() - start_time).count());
+  return result;
+}
+
+// the sensor reports pixels without depth as zero, and those never make it
+// out of the ingest pipeline
+void load_frame(const RecordingReader::Frame &frame, std::size_t point_count,
+                bob::types::PointCloud &cloud) {
+  cloud.positions.clear();
+  cloud.colors.clear();
+  for (std::size_t i = 0; i < point_count; i++) {
+    const auto &p = frame.positions[i];
+    if (p.x == 0 && p.y == 0 && p.z == 0) continue;
+    cloud.positions.push_back({p.x, p.y, p.z, 0});
+    cloud.colors.push_back(frame.colors[i]);
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <recording.pcrec> [voxel size mm] "
+                         "[keyframe interval]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  // the defaults match RadioConfiguration
+  const float voxel_size = argc > 2 ? std::strtof(argv[2], nullptr) : 50.0f;
+  const int keyframe_interval = argc > 3 ? std::atoi(argv[3]) : 30;
+  if (voxel_size < 1 || keyframe_interval < 1) {
+    std::fprintf(stderr, "voxel size and keyframe interval must be positive\n");
+    return 1;
+  }
+
+  std::unique_ptr<RecordingReader> recording;
+  try {
+    recording = std::make_unique<RecordingReader>(argv[1]);
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "failed to open recording: %s\n", e.what());
+    return 1;
+  }
+
+  Measurements serialize{"serialize (draco)"};
+  Measurements bucket{"VoxelFrame::bucket"};
+  Measurements keyframes{"DeltaEncoder keyframe"};
+  Measurements deltas{"DeltaEncoder delta"};
+  Measurements decode{"DeltaDecoder::decode"};
+
+  bob::types::PointCloud cloud;
+  VoxelFrame voxels;
+  DeltaEncoder encoder;
+  DeltaDecoder decoder;
+  const DeltaThresholds thresholds{};
+  std::size_t point_total = 0;
+  std::size_t failed_frames = 0;
+
+  const auto frame_count = recording->frame_count();
+  for (std::size_t i = 0; i < frame_count; i++) {
+    load_frame(recording->frame(i), recording->point_count(), cloud);
+    point_total += cloud.size();
+
+    const auto full_frame =
+        timed(serialize, [&] { return cloud.serialize(true); });
+    serialize.bytes.push_back(static_cast<float>(full_frame.size()));
+
+    timed(bucket, [&] {
+      voxels.bucket(cloud, voxel_size);
+      return 0;
+    });
+
+    const bool keyframe = i % keyframe_interval == 0;
+    auto &encode = keyframe ? keyframes : deltas;
+    const auto encoded = timed(encode, [&] {
+      return encoder.encode(voxels, keyframe, thresholds, true);
+    });
+    encode.bytes.push_back(static_cast<float>(encoded.size()));
+
+    const bool decoded = timed(decode, [&] {
+      return decoder.decode(encoded.data(), encoded.size(), keyframe);
+    });
+    if (!decoded) failed_frames++;
+  }
+
+  std::printf("%zu frames, %.0f points per frame, %.0fmm voxels, keyframe "
+              "every %d frames\n\n",
+              frame_count,
+              frame_count > 0 ? double(point_total) / frame_count : 0.0,
+              voxel_size, keyframe_interval);
+  std::printf("%-22s %8s %8s %8s %12s\n", "", "mean ms", "min ms", "max ms",
+              "mean bytes");
+  serialize.print();
+  bucket.print();
+  keyframes.print();
+  deltas.print();
+  decode.print();
+
+  if (failed_frames > 0) {
+    std::fprintf(stderr, "\n%zu frames failed to decode\n", failed_frames);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Measures how long the voxel grid shared by the spatial operators (denoise,
+// cluster and voxel downsample) takes to build as the cloud grows, on the
+// host (OpenMP) backend and, when a CUDA device is present, on the GPU.
+//
+//   voxel-grid-bench [voxel size mm] [runs per size]
+
+#include "../src/operators/voxel_grid.cuh"
+#include "bench_utils.h"
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <thrust/device_vector.h>
+#include <thrust/system/cuda/execution_policy.h>
+#include <thrust/system/omp/execution_policy.h>
+#include <vector>
+
+using namespace pc::bench;
+using namespace pc::operators;
+
+namespace {
+
+constexpr std::size_t point_counts[] = {100'000, 250'000, 500'000, 1'000'000,
+                                        2'000'000};
+
+struct BuildResult {
+  Timing timing;
+  std::size_t cell_count;
+};
+
+BuildResult host_builds(const SyntheticCloud &cloud, float voxel_size,
+                        int run_count) {
+  auto positions = cloud.positions;
+  auto colors = cloud.colors;
+  std::vector<int> indices(cloud.size());
+  std::iota(indices.begin(), indices.end(), 0);
+
+  const auto begin = thrust::make_zip_iterator(thrust::make_tuple(
+      positions.data(), colors.data(), indices.data()));
+  const auto end = begin + cloud.size();
+
+  HostScratchAllocator allocator;
+  const auto policy = thrust::omp::par(allocator);
+  std::size_t cell_count = 0;
+  const auto timing = time_runs(run_count, [&] {
+    VoxelGrid<HostScratchAllocator> grid(policy, allocator, begin, end,
+                                         voxel_size);
+    cell_count = grid.cell_count();
+  });
+  return {timing, cell_count};
+}
+
+BuildResult cuda_builds(const SyntheticCloud &cloud, float voxel_size,
+                        int run_count) {
+  thrust::device_vector<position> positions(cloud.positions);
+  thrust::device_vector<color> colors(cloud.colors);
+  thrust::device_vector<int> indices(cloud.size());
+  thrust::sequence(indices.begin(), indices.end());
+
+  const auto begin = thrust::make_zip_iterator(thrust::make_tuple(
+      positions.begin(), colors.begin(), indices.begin()));
+  const auto end = begin + cloud.size();
+
+  DeviceScratchAllocator allocator;
+  const auto policy = thrust::cuda::par(allocator);
+  std::size_t cell_count = 0;
+  const auto timing = time_runs(run_count, [&] {
+    VoxelGrid<DeviceScratchAllocator> grid(policy, allocator, begin, end,
+                                           voxel_size);
+    cudaDeviceSynchronize();
+    cell_count = grid.cell_count();
+  });
+  return {timing, cell_count};
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  // the default matches the denoise radius
+  const float voxel_size = argc > 1 ? std::strtof(argv[1], nullptr) : 30.0f;
+  const int run_count = argc > 2 ? std::atoi(argv[2]) : 20;
+  if (voxel_size < 1 || run_count < 1) {
+    std::fprintf(stderr, "usage: %s [voxel size mm] [runs per size]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  const bool with_cuda = cuda_device_available();
+  std::printf("%.0fmm voxels, mean of %d builds%s\n\n", voxel_size,
+              run_count, with_cuda ? "" : ", no CUDA device found");
+  std::printf("%10s %10s %12s %12s", "points", "cells", "host ms",
+              "host min ms");
+  if (with_cuda) std::printf(" %12s %12s", "cuda ms", "cuda min ms");
+  std::printf("\n");
+
+  for (const auto point_count : point_counts) {
+    const auto cloud = synthetic_cloud(point_count);
+    const auto host = host_builds(cloud, voxel_size, run_count);
+    std::printf("%10zu %10zu %12.3f %12.3f", point_count, host.cell_count,
+                host.timing.mean_ms, host.timing.min_ms);
+    if (with_cuda) {
+      const auto cuda = cuda_builds(cloud, voxel_size, run_count);
+      std::printf(" %12.3f %12.3f", cuda.timing.mean_ms, cuda.timing.min_ms);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}